@@ -1,487 +1,1486 @@
-////////////////////////////////////////////////////////////////////////////////
-// Copyright 2017 Intel Corporation
-//
-// Licensed under the Apache License, Version 2.0 (the "License"); you may not
-// use this file except in compliance with the License.  You may obtain a copy
-// of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
-// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
-// License for the specific language governing permissions and limitations
-// under the License.
-////////////////////////////////////////////////////////////////////////////////
-#include "EventViz.hpp"
-#include <algorithm>
-#include <map>
-
-namespace EventViz { 
-
-const char *kVsyncQueue = "Vsync";
-const char *kPresentQueue = "Present";
-const char *kGpuQueue = "GPU";
-const char *kCpuQueue = "CPU";
-
-template<class T>
-inline bool IntervalsIntersect(
-	T a, T b, T c, T d)
-{
-	assert(a <= b);
-	assert(c <= d);
-
-	// ([a,b] & [c,d]) not empty
-	return !(b < c || a > d);
-}
-
-EventStream::EventStream()
-{
-
-}
-
-EventStream::~EventStream()
-{
-
-}
-
-void EventStream::Trim(UINT64 MaxStartTime)
-{
-	// Trim Vsyncs
-	{
-		auto Pred = [=](const EventData *e, const UINT64 Val) { return e->Start < Val; };
-		auto Begin = Vsyncs.begin();
-		auto End = std::lower_bound(Begin, Vsyncs.end(), MaxStartTime, Pred); // first element NOT < MaxStartTime
-		Vsyncs.erase(Begin, End); // erase [Begin, End)
-	}
-
-	// Trim Events
-	{
-		auto Begin = AllEvents.begin();
-		auto End = AllEvents.lower_bound(MaxStartTime); // first element NOT < MaxStartTime
-		AllEvents.erase(Begin, End); // erase [Begin, End)
-	}
-}
-
-void EventStream::TrimToLastNSeconds(UINT Seconds)
-{
-	UINT64 MaxStartTime = QpcNow() - Seconds*g_QpcFreq;
-	Trim(MaxStartTime);
-}
-
-void EventStream::TrimToLastNVsyncs(UINT N)
-{
-	UINT VsyncCount = GetVsyncCount();
-	if (VsyncCount <= N) {
-		return;
-	}
-	Trim(Vsyncs[VsyncCount - N]->Start);
-}
-
-EventData *EventStream::Start(const char *Queue, const void *UserData, UINT64 UserID, UINT64 Time)
-{
-	if (paused) return NULL;
-
-	assert(Queue);
-
-	Time = Time ? Time : QpcNow();
-
-	auto Event = new EventData{ Queue, UserData, UserID, Time, 0 };
-	AllEvents.emplace(Time, Event);
-
-	return Event;
-}
-
-void EventStream::End(EventData *Data, UINT64 Time)
-{
-	if (!Data || paused) return;
-
-	Data->End = Time ? Time : QpcNow();
-}
-
-void EventStream::InsertEvent(const char *Queue, UINT64 StartTime, UINT64 EndTime, const void *UserData, UINT64 UserID)
-{
-	if (paused) return;
-
-	assert(StartTime && EndTime >= StartTime);
-
-	auto Event = new EventData{ Queue, UserData, UserID, StartTime, EndTime };
-	AllEvents.emplace(StartTime, Event);
-}
-
-void EventStream::Vsync(UINT64 Time)
-{
-	if (paused) return;
-
-	auto Event = EventStream::Start(kVsyncQueue, 0, 0, Time);
-	EventStream::End(Event, Time);
-	Vsyncs.push_back(Event);
-}
-
-UINT EventStream::GetVsyncCount()
-{
-	return (UINT)Vsyncs.size();
-}
-
-
-
-/// ----------------------------------------------------------------------
-///                             Drawing code
-/// ----------------------------------------------------------------------
-
-enum {
-	kQueueLineHeight = 33,
-	kPaddingPixels = 33,
-};
-
-void JoinTwoRectangles(
-	std::vector<EventViz::Line>& Lines,
-	const EventViz::Rectangle& R1,
-	const EventViz::Rectangle& R2)
-{
-	float CX0 = (R1.Left + R1.Right) / 2;
-	float CY0 = (R1.Top + R1.Bottom) / 2;
-	float CX1 = (R2.Left + R2.Right) / 2;
-	float CY1 = (R2.Top + R2.Bottom) / 2;
-
-	if (1)
-	{
-		// Direct line between rectangle centers
-		Lines.push_back({ CX0, CY0, CX1, CY1 });
-	}
-	else
-	{
-		// Z-shaped line with 3 segments
-		float CY = (CY0 + CY1) / 2;
-		Lines.push_back({ CX0, CY0, CX0, CY  });
-		Lines.push_back({ CX0, CY,  CX1, CY  });
-		Lines.push_back({ CX1, CY,  CX1, CY1 });
-	}
-}
-
-void ConnectTheDots(
-	EventViz::EventVisualization& Visualization,
-	size_t Begin1, size_t End1,
-	size_t Begin2, size_t End2,
-	bool PrimaryOnly)
-{
-	auto Rectangles = Visualization.Rectangles.data();
-	for (size_t i = Begin1; i < End1; ++i) {
-		for (size_t j = std::max(i, Begin2); j < End2; ++j) {
-			auto& R1 = Rectangles[i];
-			auto& R2 = Rectangles[j];
-			if (R1.Event->UserID == R2.Event->UserID &&
-				(!PrimaryOnly || (R1.Flags & R2.Flags & Rectangle::Primary)) &&
-				(!(R1.Sequence | R2.Sequence) || abs(R1.Sequence-R2.Sequence) == 1))
-			{
-				// Create lines between the two primary rectangles for this event
-				JoinTwoRectangles(Visualization.Lines, R1, R2);
-			}
-		}
-	}
-}
-
-void LayoutLinearQueue(std::vector<EventViz::Rectangle>& Rectangles,
-	EventViz::EventSet Events, UINT64 StartTime, UINT64 EndTime, float TimeToPixels, FloatRect Rect)
-{
-	size_t EventCount = Events.size();
-	auto EventPtrs = Events.data();
-	for (size_t i = 0; i < EventCount; ++i)
-	{
-		EventData *Event = EventPtrs[i];
-		float X0 = Rect.Left + TimeToPixels * INT64(Event->Start - StartTime);
-		float X1 = Rect.Left + TimeToPixels * INT64(Event->End   - StartTime);
-		Rectangles.push_back( { X0, Rect.Top, X1, Rect.Bottom, Event, true } );
-	}
-}
-
-void ComputeStackedQueueColumns(
-	const std::vector<EventViz::EventData*>& Events, // should be sorted by start time
-	const std::vector<UINT64>& VsyncTimes, // should be sorted by time
-	std::vector<std::vector<EventData*>>& Stacks,
-	UINT *MaxStackSize)
-{
-	// N * (log(K)+C)
-	// Each stack is in chronological (start time) order
-
-	// Scatter each event into every interval that it intersects
-
-	*MaxStackSize = 0;
-
-	if (VsyncTimes.size() < 2) {
-		return;
-	}
-
-	int K = (int)VsyncTimes.size();
-	auto Vsyncs = VsyncTimes.data();
-
-	Stacks.resize(K-1);
-
-	UINT BiggestStack = 0;
-
-	int EventCount = (int)Events.size();
-	for (int i = 0; i < EventCount; ++i)
-	{
-		auto Event = Events[i];
-		auto StartTime = Event->Start;
-		auto EndTime = Event->End == UINT64_MAX ? Event->Start : Event->End;
-		auto FirstVsyncPtr = std::lower_bound(Vsyncs, Vsyncs + K, StartTime); // First Vsync that is >= StartTime
-		auto LastVsyncPtr = std::upper_bound(Vsyncs, Vsyncs + K, EndTime); // First Vysnc that is > EndTime
-		
-		int FirstVsyncIndex = std::max(0, int(FirstVsyncPtr - Vsyncs - 1));
-		int LastVsyncIndex = std::min(K-1, int(LastVsyncPtr - Vsyncs));
-
-		for (int i = FirstVsyncIndex; i < LastVsyncIndex; ++i)
-		{
-			if (Vsyncs[i] >= EndTime) {
-				continue;
-			}
-			assert(IntervalsIntersect(StartTime, EndTime, Vsyncs[i], Vsyncs[i + 1]));
-			Stacks[i].push_back(Event);
-			UINT StackSize = (UINT)Stacks[i].size();
-			BiggestStack = std::max(BiggestStack, StackSize);
-		}
-	}
-
-	*MaxStackSize = BiggestStack;
-}
-
-void LayoutStackedQueue(
-	std::map<UINT64, int>& SequenceCounter,
-	std::vector<EventViz::Rectangle>& Rectangles,
-	const std::vector<std::vector<EventData*>>& Stacks,
-	const std::vector<UINT64>& VsyncTimes,
-	UINT64 StartTime, UINT64 EndTime,
-	float TimeToPixels, FloatRect Rect, UINT Rows)
-{
-	// for each interval:
-	// find all entries overlapping the interval
-	// draw them from bottom to top, least recent to most recent
-
-	size_t K = Stacks.size();
-	if (!K) return;
-
-	assert(VsyncTimes.size() == K + 1);
-
-	for (size_t i = 0; i < K; ++i)
-	{
-		auto& Stack = Stacks[i];
-		// from bottom to top
-		UINT64 IntervalStart = VsyncTimes[i];
-		UINT64 IntervalEnd = VsyncTimes[i + 1];
-		UINT StackSize = (UINT)Stack.size();
-		UINT Lift = Rows - StackSize;
-		for (UINT j = 0; j < StackSize; ++j) {
-			// The END of the stack contains the most recent item, which needs to go at the bottom.
-			auto Event = Stack[StackSize-1-j];
-			auto BlockStart = std::max(Event->Start, IntervalStart);
-			auto BlockEnd = std::min(Event->End, IntervalEnd);
-			float Y0 = Rect.Bottom-(j+1+Lift)*kQueueLineHeight;
-			float Y1 = Rect.Bottom -(j+Lift)*kQueueLineHeight;
-			float X0 = Rect.Left + TimeToPixels * INT64(BlockStart - StartTime);
-			float X1 = Rect.Left + TimeToPixels * INT64(BlockEnd - StartTime);
-			int Flags = 0;
-
-			auto& SequenceIndex = SequenceCounter[Event->UserID];
-			SequenceIndex += 1;
-#if 0
-			// last rectangle before presenting is Primary
-			if (Event->End <= IntervalEnd && Event->End > IntervalStart) {
-				Flags |= Rectangle::Primary;
-			}
-#else
-			// first rectangle entering the queue is Primary
-			if (Event->Start >= IntervalStart && Event->Start <= IntervalEnd) {
-				Flags |= Rectangle::Primary;
-			}
-#endif
-			if (Event->End == UINT64_MAX) {
-				Flags |= Rectangle::Dropped;
-			}
-			Rectangles.push_back({ X0, Y0, X1, Y1, Event, Flags, SequenceIndex });
-		}
-	}
-}
-
-void LayoutDisplayRectangles(
-	std::map<UINT64, int>& SequenceCounter,
-	std::vector<EventViz::Rectangle>& Rectangles,
-	const std::vector<std::vector<EventData*>>& PresentStacks,
-	const std::vector<UINT64>& VsyncTimes,
-	UINT64 StartTime, UINT64 EndTime,
-	float TimeToPixels, FloatRect Rect)
-{
-	size_t K = PresentStacks.size();
-	if (!K) return;
-
-	assert(VsyncTimes.size() == K + 1);
-
-	EventData *Display = 0;
-	int Flags = 0;
-
-	for (size_t i = 0; i < K; ++i)
-	{
-		if (Display)
-		{
-			UINT64 IntervalStart = VsyncTimes[i];
-			UINT64 IntervalEnd = VsyncTimes[i + 1];
-			float Y0 = Rect.Top;
-			float Y1 = Rect.Bottom;
-			float X0 = Rect.Left + TimeToPixels * INT64(IntervalStart - StartTime);
-			float X1 = Rect.Left + TimeToPixels * INT64(IntervalEnd - StartTime);
-			auto& SequenceIndex = SequenceCounter[Display->UserID];
-			SequenceIndex += 1;
-			Rectangles.push_back({ X0, Y0, X1, Y1, Display, Flags, SequenceIndex });
-			Flags = 0;
-		}
-
-		auto& Stack = PresentStacks[i];
-		if (!Stack.empty())
-		{
-			Display = Stack[0];
-			Flags = Rectangle::Primary;
-		}
-	}
-}
-
-void CreateVisualization(EventStream& Stream, UINT FirstVsync, UINT LastVsync, FloatRect ScreenRectInDips, EventVisualization& Visualization)
-{
-	// We have three types of visualization:
-
-	// Linear queues, Stacked queues, and Vsyncs.
-
-	// The CPU & GPU queue are linear; The Present queue is stacked.
-	// Vsyncs are represented as vertical lines.
-
-	UINT VsyncCount = Stream.GetVsyncCount();
-	if (Stream.AllEvents.empty() ||
-		LastVsync <= FirstVsync ||
-		FirstVsync >= VsyncCount ||
-		LastVsync >= VsyncCount)
-	{
-		return;
-	}
-
-	UINT64 MaxSearchRadius = g_QpcFreq/4; // 1/4 second
-
-	UINT64 StartTime = Stream.Vsyncs[FirstVsync]->Start;
-	UINT64 EndTime = Stream.Vsyncs[LastVsync]->Start;
-
-	auto First = Stream.AllEvents.lower_bound(StartTime - MaxSearchRadius);
-	auto Last = Stream.AllEvents.upper_bound(EndTime + MaxSearchRadius);
-
-	// FIXME: make these static?
-	EventSet PresentQ, GpuQ, CpuQ;
-	std::vector<UINT64> VsyncTimes;
-	PresentQ.reserve(1000);
-	GpuQ.reserve(1000);
-	CpuQ.reserve(1000);
-	for (auto it = First; it != Last; ++it)
-	{
-		EventData *Data = it->second.get();
-		if (Data->End &&
-			IntervalsIntersect(
-				StartTime, EndTime,
-				Data->Start, Data->End))
-		{
-			if (Data->Queue == kPresentQueue)
-			{
-				PresentQ.push_back(Data);
-			}
-			else if (Data->Queue == kGpuQueue)
-			{
-				GpuQ.push_back(Data);
-			}
-			else if (Data->Queue == kCpuQueue)
-			{
-				CpuQ.push_back(Data);
-			}
-			else if (Data->Queue == kVsyncQueue)
-			{
-				VsyncTimes.push_back(Data->Start);
-			}
-		}
-	}
-
-	Visualization.Lines.clear();
-	Visualization.Rectangles.clear();
-
-	// Layout from the bottom up: CpuQ, GpuQ, PresentQ
-	float y = ScreenRectInDips.Bottom;
-	FloatRect Rect;
-
-	Rect.Left = ScreenRectInDips.Left + kPaddingPixels;
-	Rect.Right = ScreenRectInDips.Right - kPaddingPixels;
-
-	UINT64 TimeWidth = EndTime - StartTime + 1;
-	float PixelWidth = Rect.Right - Rect.Left + 1;
-	float TimeToPixels = PixelWidth / TimeWidth;
-
-	std::map<UINT64, int> SequenceCounter;
-
-	// CpuQ
-	size_t CpuRectBegin, CpuRectEnd;
-	{
-		Rect.Top = y - kQueueLineHeight;
-		Rect.Bottom = y;
-		CpuRectBegin = Visualization.Rectangles.size();
-		LayoutLinearQueue(Visualization.Rectangles, CpuQ, StartTime, EndTime, TimeToPixels, Rect);
-		CpuRectEnd = Visualization.Rectangles.size();
-		y -= kQueueLineHeight + kPaddingPixels;
-	}
-
-	// GpuQ
-	size_t GpuRectBegin, GpuRectEnd;
-	{
-		Rect.Top = y - kQueueLineHeight;
-		Rect.Bottom = y;
-		GpuRectBegin = Visualization.Rectangles.size();
-		LayoutLinearQueue(Visualization.Rectangles, GpuQ, StartTime, EndTime, TimeToPixels, Rect);
-		GpuRectEnd = Visualization.Rectangles.size();
-		y -= kQueueLineHeight + kPaddingPixels;
-	}
-
-	// PresentQ
-	size_t PresentRectBegin, PresentRectEnd;
-	std::vector<std::vector<EventData*>> PresentStacks;
-	{
-		UINT Rows;
-		ComputeStackedQueueColumns(PresentQ, VsyncTimes, PresentStacks, &Rows);
-		Rect.Top = y - Rows*kQueueLineHeight;
-		Rect.Bottom = y;
-		PresentRectBegin = Visualization.Rectangles.size();
-		LayoutStackedQueue(SequenceCounter, Visualization.Rectangles, PresentStacks, VsyncTimes, StartTime, EndTime, TimeToPixels, Rect, Rows);
-		PresentRectEnd = Visualization.Rectangles.size();
-		y = Rect.Top - kPaddingPixels;
-	}
-	
-	// DisplayQ:
-	size_t DisplayRectBegin, DisplayRectEnd;
-	{
-		Rect.Top = y - kQueueLineHeight;
-		Rect.Bottom = y;
-		DisplayRectBegin = Visualization.Rectangles.size();
-		LayoutDisplayRectangles(SequenceCounter, Visualization.Rectangles, PresentStacks, VsyncTimes, StartTime, EndTime, TimeToPixels, Rect);
-		DisplayRectEnd = Visualization.Rectangles.size();
-	}
-
-	ConnectTheDots(Visualization, CpuRectBegin, CpuRectEnd, GpuRectBegin, GpuRectEnd, true);
-	//ConnectTheDots(Visualization, GpuRectBegin, GpuRectEnd, PresentRectBegin, PresentRectEnd, true);
-
-	ConnectTheDots(Visualization, CpuRectBegin, CpuRectEnd, PresentRectBegin, PresentRectEnd, true);
-	ConnectTheDots(Visualization, PresentRectBegin, PresentRectEnd, PresentRectBegin, PresentRectEnd, false);
-	ConnectTheDots(Visualization, PresentRectBegin, PresentRectEnd, DisplayRectBegin, DisplayRectEnd, false);
-
-	// Vsyncs
-	{
-		float Y0 = Rect.Top;
-		float Y1 = ScreenRectInDips.Bottom;
-		for (size_t i = 0; i < VsyncTimes.size(); ++i)
-		{
-			float X0 = Rect.Left + TimeToPixels * (VsyncTimes[i] - StartTime);
-			Visualization.Lines.push_back({ X0, Y0, X0, Y1 });
-		}
-	}
-}
-
-}
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#include "EventViz.hpp"
+#include <algorithm>
+
+namespace EventViz { 
+
+template<class T>
+inline bool IntervalsIntersect(
+	T a, T b, T c, T d)
+{
+	assert(a <= b);
+	assert(c <= d);
+
+	// ([a,b] & [c,d]) not empty
+	return !(b < c || a > d);
+}
+
+EventPool::EventPool()
+	: FreeList(0)
+	, LiveCount(0)
+{
+
+}
+
+EventData *EventPool::Allocate()
+{
+	if (!FreeList)
+	{
+		// Grow by one chunk and thread all of its slots onto the free list.
+		Chunks.emplace_back(new Slot[kChunkSize]);
+		Slot *Chunk = Chunks.back().get();
+		for (size_t i = 0; i < kChunkSize; ++i) {
+			Chunk[i].Next = i + 1 < kChunkSize ? &Chunk[i + 1] : 0;
+		}
+		FreeList = Chunk;
+	}
+
+	Slot *S = FreeList;
+	FreeList = S->Next;
+	++LiveCount;
+	return &S->Data;
+}
+
+void EventPool::Free(EventData *Data)
+{
+	assert(Data && LiveCount);
+
+	Slot *S = reinterpret_cast<Slot*>(Data);
+	S->Next = FreeList;
+	FreeList = S;
+	--LiveCount;
+}
+
+EventStream::EventStream()
+	: HistoryCapacity(0)
+	, CommitCount(0)
+	, CommitLog(kCommitLogSize)
+	, TrimmedBefore(0)
+{
+	RegisterQueue("Vsync");
+	RegisterQueue("Present");
+	RegisterQueue("GPU");
+	RegisterQueue("CPU");
+	assert(GetQueueCount() == kBuiltinQueueCount);
+}
+
+EventStream::~EventStream()
+{
+	// Recorders refer to the stream until they are destroyed
+	assert(Recorders.empty());
+	while (!Sinks.empty()) {
+		Sinks.back()->Detach();
+	}
+}
+
+UINT GetDurationClass(UINT64 Start, UINT64 End)
+{
+	UINT64 Duration = (VisibleEnd(Start, End) - Start) >> kShortDurationBits;
+	if (!Duration) {
+		return 0;
+	}
+	// 1 + floor(log2(Duration))
+	UINT Class = 1;
+	for (UINT Shift = 32; Shift; Shift /= 2) {
+		if (Duration >> Shift) {
+			Duration >>= Shift;
+			Class += Shift;
+		}
+	}
+	return Class;
+}
+
+UINT64 GetMaxDuration(UINT Class)
+{
+	return UINT64_MAX >> (64 - kShortDurationBits - Class);
+}
+
+// Where to start looking in a class for events that reach StartTime
+static UINT64 GetSearchStart(UINT64 StartTime, UINT Class)
+{
+	UINT64 Margin = GetMaxDuration(Class);
+	return StartTime > Margin ? StartTime - Margin : 0;
+}
+
+// Merges the sorted runs [Bounds[i], Bounds[i+1]) of Items into one, from
+// the last run to the first: each run is merged with what follows it, which
+// is copied out and merged back from the end. The first run, the short
+// events, is most of the items, and it is only moved where later ones land
+// in it. Events that start together keep the order of their runs.
+template<class T, class Less>
+static void MergeRuns(std::vector<T>& Items, const std::vector<size_t>& Bounds, std::vector<T>& Scratch, Less Before)
+{
+	for (size_t i = Bounds.size() - 1; i-- > 1; )
+	{
+		size_t RunBegin = Bounds[i - 1];
+		size_t A = Bounds[i], Out = Bounds.back();
+		Scratch.assign(Items.begin() + A, Items.begin() + Out);
+		size_t B = Scratch.size();
+		while (B) {
+			if (A > RunBegin && Before(Scratch[B - 1], Items[A - 1])) {
+				Items[--Out] = Items[--A];
+			} else {
+				Items[--Out] = Scratch[--B];
+			}
+		}
+	}
+}
+
+// The Index-th start in start order across the classes of a store, where
+// Size(c) is the number of events of class c and Start(c, i) the start of
+// the i-th of them. A store whose events all have one class, like the
+// vsyncs, is indexed directly; otherwise the classes are walked in order.
+template<class SizeOf, class StartOf>
+static UINT64 GetStartAcrossClasses(size_t Index, size_t Count, UINT ClassCount, SizeOf Size, StartOf Start)
+{
+	assert(Index < Count);
+
+	for (UINT c = 0; c < ClassCount; ++c) {
+		if (Size(c) == Count) {
+			return Start(c, Index);
+		}
+	}
+
+	size_t Next[kDurationClasses] = {};
+	for (;;)
+	{
+		UINT Earliest = kDurationClasses;
+		for (UINT c = 0; c < ClassCount; ++c) {
+			if (Next[c] < Size(c) &&
+				(Earliest == kDurationClasses || Start(c, Next[c]) < Start(Earliest, Next[Earliest])))
+			{
+				Earliest = c;
+			}
+		}
+		if (!Index--) {
+			return Start(Earliest, Next[Earliest]);
+		}
+		++Next[Earliest];
+	}
+}
+
+void EventTimeline::Insert(const EventData& Event)
+{
+	EventData *Record = Pool.Allocate();
+	*Record = Event;
+	UINT Class = GetDurationClass(Event.Start, Event.End);
+	Classes[Class].emplace(Event.Start, Record);
+	ClassCount = std::max(ClassCount, Class + 1);
+	++Count;
+}
+
+void EventTimeline::Trim(UINT64 MaxStartTime)
+{
+	for (UINT c = 0; c < ClassCount; ++c)
+	{
+		auto& Events = Classes[c];
+		auto Begin = Events.begin();
+		auto End = Events.lower_bound(MaxStartTime); // first element NOT < MaxStartTime
+		for (auto it = Begin; it != End; ++it) {
+			Pool.Free(it->second); // return the records to the slab in one sweep
+		}
+		Count -= End - Begin;
+		Events.erase(Begin, End); // erase [Begin, End)
+	}
+}
+
+void EventTimeline::TrimToSize(size_t MaxCount)
+{
+	// The oldest go first, whatever their class
+	while (Count > MaxCount)
+	{
+		EventMapT *Oldest = 0;
+		for (UINT c = 0; c < ClassCount; ++c) {
+			auto& Events = Classes[c];
+			if (!Events.empty() && (!Oldest || Events.begin()->first < Oldest->begin()->first)) {
+				Oldest = &Events;
+			}
+		}
+		auto First = Oldest->begin();
+		Pool.Free(First->second);
+		Oldest->erase(First);
+		--Count;
+	}
+}
+
+UINT64 EventTimeline::GetStart(size_t Index)
+{
+	return GetStartAcrossClasses(Index, Count, ClassCount,
+		[this](UINT c) { return Classes[c].size(); },
+		[this](UINT c, size_t i) { return Classes[c].begin()[i].first; });
+}
+
+void EventTimeline::Gather(UINT64 StartTime, UINT64 EndTime, EventSet& Out)
+{
+	Runs.clear();
+	Runs.push_back(Out.size());
+	for (UINT c = 0; c < ClassCount; ++c)
+	{
+		auto& Events = Classes[c];
+		if (Events.empty()) {
+			continue;
+		}
+		auto Last = Events.upper_bound(EndTime);
+		for (auto it = Events.lower_bound(GetSearchStart(StartTime, c)); it != Last; ++it)
+		{
+			EventData *Data = it->second;
+			if (VisibleEnd(Data->Start, Data->End) >= StartTime)
+			{
+				Out.push_back(Data);
+			}
+		}
+		if (Out.size() != Runs.back()) {
+			Runs.push_back(Out.size());
+		}
+	}
+	MergeRuns(Out, Runs, MergeScratch, [](const EventData *a, const EventData *b) { return a->Start < b->Start; });
+}
+
+void EventColumns::Insert(const EventData& Event)
+{
+	UINT Class = GetDurationClass(Event.Start, Event.End);
+	Classes[Class].Unsorted.push_back(Event);
+	ClassCount = std::max(ClassCount, Class + 1);
+	++Count;
+}
+
+void EventColumns::Trim(UINT64 MaxStartTime)
+{
+	for (UINT c = 0; c < ClassCount; ++c)
+	{
+		auto& C = Classes[c];
+		Sort(C);
+		size_t Head = std::lower_bound(C.Start.begin() + C.Head, C.Start.end(), MaxStartTime) - C.Start.begin();
+		Count -= Head - C.Head;
+		C.Head = Head;
+		Compact(C);
+	}
+}
+
+void EventColumns::TrimToSize(size_t MaxCount)
+{
+	for (UINT c = 0; c < ClassCount; ++c) {
+		Sort(Classes[c]);
+	}
+
+	// The oldest go first, whatever their class
+	while (Count > MaxCount)
+	{
+		Columns *Oldest = 0;
+		for (UINT c = 0; c < ClassCount; ++c) {
+			auto& C = Classes[c];
+			if (C.Head < C.Start.size() && (!Oldest || C.Start[C.Head] < Oldest->Start[Oldest->Head])) {
+				Oldest = &C;
+			}
+		}
+		Oldest->Head += 1;
+		--Count;
+	}
+
+	for (UINT c = 0; c < ClassCount; ++c) {
+		Compact(Classes[c]);
+	}
+}
+
+void EventColumns::Compact(Columns& C)
+{
+	// Trimming only advances Head. Once the dead prefix outgrows the live
+	// rows, the live rows are moved down, which is O(1) amortized per row.
+	size_t Head = C.Head;
+	if (!Head || Head < C.Start.size() - Head) {
+		return;
+	}
+	C.Start.erase(C.Start.begin(), C.Start.begin() + Head);
+	C.End.erase(C.End.begin(), C.End.begin() + Head);
+	C.UserID.erase(C.UserID.begin(), C.UserID.begin() + Head);
+	C.UserData.erase(C.UserData.begin(), C.UserData.begin() + Head);
+	C.Head = 0;
+}
+
+UINT64 EventColumns::GetStart(size_t Index)
+{
+	for (UINT c = 0; c < ClassCount; ++c) {
+		Sort(Classes[c]);
+	}
+	return GetStartAcrossClasses(Index, Count, ClassCount,
+		[this](UINT c) { return Classes[c].Size(); },
+		[this](UINT c, size_t i) { return Classes[c].Start[Classes[c].Head + i]; });
+}
+
+void EventColumns::Gather(UINT64 StartTime, UINT64 EndTime, EventSet& Out)
+{
+	Rows.clear();
+	Runs.clear();
+	Runs.push_back(0);
+	for (UINT c = 0; c < ClassCount; ++c)
+	{
+		auto& C = Classes[c];
+		if (!C.Size()) {
+			continue;
+		}
+		Sort(C);
+
+		auto Begin = C.Start.begin();
+		size_t Last = std::upper_bound(Begin + C.Head, C.Start.end(), EndTime) - Begin;
+		size_t First = std::lower_bound(Begin + C.Head, Begin + Last, GetSearchStart(StartTime, c)) - Begin;
+
+		// Branch-free compaction of the candidates that reach into the window;
+		// this loop only touches the Start and End columns.
+		Selected.resize(Last - First);
+		auto Starts = C.Start.data();
+		auto Ends = C.End.data();
+		auto Indices = Selected.data();
+		size_t Selections = 0;
+		for (size_t i = First; i < Last; ++i)
+		{
+			Indices[Selections] = (UINT)i;
+			Selections += VisibleEnd(Starts[i], Ends[i]) >= StartTime;
+		}
+
+		for (size_t i = 0; i < Selections; ++i) {
+			Rows.push_back(GetRow(C, Indices[i]));
+		}
+		if (Rows.size() != Runs.back()) {
+			Runs.push_back(Rows.size());
+		}
+	}
+	MergeRuns(Rows, Runs, MergeScratch, [](const EventData& a, const EventData& b) { return a.Start < b.Start; });
+
+	for (auto& Row : Rows) {
+		Out.push_back(&Row);
+	}
+}
+
+void EventColumns::Sort(Columns& C)
+{
+	auto& Unsorted = C.Unsorted;
+	if (Unsorted.empty()) {
+		return;
+	}
+
+	// Only the tail of the columns that is newer than the oldest unsorted
+	// event needs to be merged; usually that tail is empty.
+	auto ByStart = [](const EventData& a, const EventData& b) { return a.Start < b.Start; };
+	std::sort(Unsorted.begin(), Unsorted.end(), ByStart);
+
+	size_t N = C.Start.size();
+	size_t MergeBegin = std::upper_bound(C.Start.begin() + C.Head, C.Start.end(), Unsorted[0].Start) - C.Start.begin();
+
+	MergeScratch.clear();
+	for (size_t i = MergeBegin; i < N; ++i) {
+		MergeScratch.push_back(GetRow(C, i));
+	}
+
+	Resize(C, N + Unsorted.size());
+
+	size_t Out = MergeBegin, A = 0, B = 0;
+	while (A < MergeScratch.size() && B < Unsorted.size()) {
+		SetRow(C, Out++, ByStart(Unsorted[B], MergeScratch[A]) ? Unsorted[B++] : MergeScratch[A++]);
+	}
+	while (A < MergeScratch.size()) {
+		SetRow(C, Out++, MergeScratch[A++]);
+	}
+	while (B < Unsorted.size()) {
+		SetRow(C, Out++, Unsorted[B++]);
+	}
+
+	Unsorted.clear();
+}
+
+void EventColumns::Resize(Columns& C, size_t Count)
+{
+	C.Start.resize(Count);
+	C.End.resize(Count);
+	C.UserID.resize(Count);
+	C.UserData.resize(Count);
+}
+
+void EventColumns::SetRow(Columns& C, size_t Index, const EventData& Row)
+{
+	C.Start[Index] = Row.Start;
+	C.End[Index] = Row.End;
+	assert(Row.Queue == Queue);
+	C.UserID[Index] = Row.UserID;
+	C.UserData[Index] = Row.UserData;
+}
+
+EventData EventColumns::GetRow(Columns& C, size_t Index)
+{
+	return { Queue, C.UserData[Index], C.UserID[Index], C.Start[Index], C.End[Index] };
+}
+
+QueueID EventStream::RegisterQueue(const char *Name)
+{
+	assert(Name);
+
+	QueueID Count = (QueueID)Tracks.size();
+	for (QueueID i = 0; i < Count; ++i) {
+		if (Tracks[i].Name == Name) {
+			return i;
+		}
+	}
+
+	Tracks.emplace_back();
+	Tracks.back().Name = Name;
+#if EVENTVIZ_COLUMNAR_STORE
+	Tracks.back().Events.Queue = Count;
+#endif
+	return Count;
+}
+
+void EventStream::Trim(UINT64 MaxStartTime)
+{
+	// Trim events that were started but never ended
+	for (UINT i = 0; i < Pending.size(); ++i) {
+		if ((Pending[i].Generation & 1) && Pending[i].Event.Start < MaxStartTime) {
+			ReleasePending(i);
+		}
+	}
+
+	// Logged, so that a replay trims at the same point
+	Log({ kTrimRecord, 0, 0, MaxStartTime, MaxStartTime });
+
+	// Trim Events (this includes the vsyncs)
+	TrimmedBefore = std::max(TrimmedBefore, MaxStartTime);
+	for (auto& Track : Tracks) {
+		Track.Events.Trim(MaxStartTime);
+		TrimToCapacity(Track);
+	}
+}
+
+void EventStream::SetHistoryBytes(size_t BytesPerQueue)
+{
+	HistoryCapacity = BytesPerQueue ? std::max<size_t>(1, BytesPerQueue / EventStoreT::kBytesPerEvent) : 0;
+}
+
+void EventStream::TrimToCapacity(Track& Track)
+{
+	if (HistoryCapacity && Track.Events.Size() > HistoryCapacity) {
+		Track.Events.TrimToSize(HistoryCapacity);
+		// Only events up to (and maybe at) the new first start are gone.
+		TrimmedBefore = std::max(TrimmedBefore, Track.Events.GetStart(0) + 1);
+	}
+}
+
+void EventStream::TrimToLastNSeconds(UINT Seconds)
+{
+	UINT64 MaxStartTime = QpcNow() - Seconds*g_QpcFreq;
+	Trim(MaxStartTime);
+}
+
+void EventStream::TrimToLastNVsyncs(UINT N)
+{
+	UINT VsyncCount = GetVsyncCount();
+	if (VsyncCount <= N) {
+		return;
+	}
+	Trim(GetVsyncTime(VsyncCount - N));
+}
+
+EventHandle EventStream::Start(QueueID Queue, const void *UserData, UINT64 UserID, UINT64 Time)
+{
+	if (paused) return 0;
+
+	assert(Queue < GetQueueCount());
+
+	Time = Time ? Time : QpcNow();
+
+	UINT Index;
+	if (FreePending.empty()) {
+		Index = (UINT)Pending.size();
+		Pending.emplace_back();
+	} else {
+		Index = FreePending.back();
+		FreePending.pop_back();
+	}
+
+	auto& Slot = Pending[Index];
+	Slot.Event = { Queue, UserData, UserID, Time, 0 };
+	Slot.Generation += 1;
+	assert(Slot.Generation & 1);
+
+	return (EventHandle(Slot.Generation) << 32) | Index;
+}
+
+void EventStream::End(EventHandle Handle, UINT64 Time)
+{
+	if (!Handle || paused) return;
+
+	UINT Index = UINT(Handle);
+	if (Index >= Pending.size() || Pending[Index].Generation != UINT(Handle >> 32)) {
+		return; // already ended, or trimmed
+	}
+	ReleasePending(Index);
+
+	auto& Event = Pending[Index].Event;
+	Event.End = Time ? Time : QpcNow();
+	Commit(Event);
+}
+
+void EventStream::ReleasePending(UINT Index)
+{
+	Pending[Index].Generation += 1;
+	FreePending.push_back(Index);
+}
+
+void EventStream::InsertEvent(QueueID Queue, UINT64 StartTime, UINT64 EndTime, const void *UserData, UINT64 UserID)
+{
+	if (paused) return;
+
+	assert(Queue < GetQueueCount());
+	assert(StartTime && EndTime >= StartTime);
+
+	Commit({ Queue, UserData, UserID, StartTime, EndTime });
+}
+
+void EventStream::Commit(const EventData& Event)
+{
+	Log(Event);
+	auto& Track = Tracks[Event.Queue];
+	Track.Events.Insert(Event);
+	TrimToCapacity(Track);
+}
+
+void EventStream::Log(const EventData& Record)
+{
+	CommitLog[CommitCount++ & (kCommitLogSize - 1)] = Record;
+	for (CommitSink *Sink : Sinks) {
+		Sink->Records.push_back(Record);
+	}
+}
+
+bool EventStream::GetEarliestCommitSince(UINT64 Count, UINT64 *EarliestStart)
+{
+	if (Count > CommitCount || CommitCount - Count > kCommitLogSize) {
+		return false;
+	}
+	UINT64 Earliest = UINT64_MAX;
+	for (UINT64 i = Count; i < CommitCount; ++i) {
+		auto& Record = CommitLog[i & (kCommitLogSize - 1)];
+		if (Record.Queue != kTrimRecord) {
+			Earliest = std::min(Earliest, Record.Start);
+		}
+	}
+	*EarliestStart = Earliest;
+	return true;
+}
+
+bool EventStream::GetCommitsSince(UINT64 Count, std::vector<EventData>& Records)
+{
+	if (Count > CommitCount || CommitCount - Count > kCommitLogSize) {
+		return false;
+	}
+	for (UINT64 i = Count; i < CommitCount; ++i) {
+		Records.push_back(CommitLog[i & (kCommitLogSize - 1)]);
+	}
+	return true;
+}
+
+void EventStream::GetAllEvents(std::vector<EventData>& Records)
+{
+	EventSet Events;
+	for (auto& Track : Tracks) {
+		Events.clear();
+		Track.Events.Gather(0, UINT64_MAX, Events);
+		for (EventData *Event : Events) {
+			Records.push_back(*Event);
+		}
+	}
+}
+
+void EventStream::Replay(const std::vector<EventData>& Records)
+{
+	for (auto& Record : Records) {
+		if (Record.Queue == kTrimRecord) {
+			Trim(Record.Start);
+		} else {
+			InsertEvent(Record.Queue, Record.Start, Record.End, Record.UserData, Record.UserID);
+		}
+	}
+}
+
+void CommitSink::Attach(EventStream& Stream)
+{
+	Detach();
+	this->Stream = &Stream;
+	Stream.Sinks.push_back(this);
+}
+
+void CommitSink::Detach()
+{
+	if (Stream) {
+		auto& Sinks = Stream->Sinks;
+		Sinks.erase(std::find(Sinks.begin(), Sinks.end(), this));
+		Stream = 0;
+	}
+}
+
+void EventStream::Vsync(UINT64 Time)
+{
+	if (paused) return;
+
+	Time = Time ? Time : QpcNow();
+
+	EventStream::InsertEvent(kVsyncQueue, Time, Time);
+}
+
+void EventStream::Flush()
+{
+	std::lock_guard<std::mutex> Lock(RecordersLock);
+
+	EventData Event;
+	for (EventRecorder *Recorder : Recorders) {
+		while (Recorder->Pop(&Event)) {
+			InsertEvent(Event.Queue, Event.Start, Event.End, Event.UserData, Event.UserID);
+		}
+	}
+
+	for (auto& Orphan : Orphans) {
+		InsertEvent(Orphan.Queue, Orphan.Start, Orphan.End, Orphan.UserData, Orphan.UserID);
+	}
+	Orphans.clear();
+}
+
+UINT EventStream::GetVsyncCount()
+{
+	return (UINT)Tracks[kVsyncQueue].Events.Size();
+}
+
+UINT64 EventStream::GetVsyncTime(UINT Index)
+{
+	return Tracks[kVsyncQueue].Events.GetStart(Index);
+}
+
+EventRecorder::EventRecorder(EventStream& Stream, UINT Capacity)
+	: Stream(Stream)
+	, WriteIndex(0)
+	, ReadIndex(0)
+	, Dropped(0)
+{
+	size_t Size = 1;
+	while (Size < Capacity) {
+		Size *= 2;
+	}
+	Ring.resize(Size);
+	Mask = Size - 1;
+
+	std::lock_guard<std::mutex> Lock(Stream.RecordersLock);
+	Stream.Recorders.push_back(this);
+}
+
+EventRecorder::~EventRecorder()
+{
+	std::lock_guard<std::mutex> Lock(Stream.RecordersLock);
+
+	// Hand whatever was not flushed yet over to the stream.
+	EventData Event;
+	while (Pop(&Event)) {
+		Stream.Orphans.push_back(Event);
+	}
+
+	auto& Recorders = Stream.Recorders;
+	Recorders.erase(std::find(Recorders.begin(), Recorders.end(), this));
+}
+
+EventData *EventRecorder::Start(QueueID Queue, const void *UserData, UINT64 UserID, UINT64 Time)
+{
+	Time = Time ? Time : QpcNow();
+
+	auto Event = Open.Allocate();
+	*Event = { Queue, UserData, UserID, Time, 0 };
+	return Event;
+}
+
+void EventRecorder::End(EventData *Data, UINT64 Time)
+{
+	if (!Data) return;
+
+	Data->End = Time ? Time : QpcNow();
+	Push(*Data);
+	Open.Free(Data);
+}
+
+void EventRecorder::InsertEvent(QueueID Queue, UINT64 StartTime, UINT64 EndTime, const void *UserData, UINT64 UserID)
+{
+	assert(StartTime && EndTime >= StartTime);
+
+	Push({ Queue, UserData, UserID, StartTime, EndTime });
+}
+
+void EventRecorder::Push(const EventData& Event)
+{
+	size_t Write = WriteIndex.load(std::memory_order_relaxed);
+	size_t Read = ReadIndex.load(std::memory_order_acquire);
+	if (Write - Read > Mask) {
+		Dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	Ring[Write & Mask] = Event;
+	WriteIndex.store(Write + 1, std::memory_order_release);
+}
+
+bool EventRecorder::Pop(EventData *Event)
+{
+	size_t Read = ReadIndex.load(std::memory_order_relaxed);
+	size_t Write = WriteIndex.load(std::memory_order_acquire);
+	if (Read == Write) {
+		return false;
+	}
+	*Event = Ring[Read & Mask];
+	ReadIndex.store(Read + 1, std::memory_order_release);
+	return true;
+}
+
+
+
+/// ----------------------------------------------------------------------
+///                             Drawing code
+/// ----------------------------------------------------------------------
+
+enum {
+	kQueueLineHeight = 33,
+	kPaddingPixels = 33,
+	kMinRectanglePixels = 1, // narrower ones are merged with their neighbors
+};
+
+void JoinTwoRectangles(
+	std::vector<EventViz::Line>& Lines,
+	const EventViz::Rectangle& R1,
+	const EventViz::Rectangle& R2)
+{
+	float CX0 = (R1.Left + R1.Right) / 2;
+	float CY0 = (R1.Top + R1.Bottom) / 2;
+	float CX1 = (R2.Left + R2.Right) / 2;
+	float CY1 = (R2.Top + R2.Bottom) / 2;
+
+	if (1)
+	{
+		// Direct line between rectangle centers
+		Lines.push_back({ CX0, CY0, CX1, CY1 });
+	}
+	else
+	{
+		// Z-shaped line with 3 segments
+		float CY = (CY0 + CY1) / 2;
+		Lines.push_back({ CX0, CY0, CX0, CY  });
+		Lines.push_back({ CX0, CY,  CX1, CY  });
+		Lines.push_back({ CX1, CY,  CX1, CY1 });
+	}
+}
+
+// Joins rectangle i of [Begin1, End1) with rectangle j of [max(i, Begin2), End2)
+// when they belong to the same event. The second range is hashed on UserID,
+// with the rectangles of each ID chained in order, so this takes time linear
+// in the rectangles and links rather than comparing every pair, and still
+// emits the links in the same order.
+void ConnectTheDots(
+	EventViz::EventVisualization& Visualization,
+	size_t Begin1, size_t End1,
+	size_t Begin2, size_t End2,
+	bool PrimaryOnly)
+{
+	if (Begin1 >= End1 || Begin2 >= End2) {
+		return;
+	}
+
+	const size_t None = ~size_t(0);
+	auto Rectangles = Visualization.Rectangles.data();
+
+	// Open addressing, at most half full
+	size_t Mask = 15;
+	while (Mask < 2 * (End2 - Begin2)) {
+		Mask = 2 * Mask + 1;
+	}
+	auto& Keys = Visualization.Cache.LinkKeys;
+	auto& Heads = Visualization.Cache.LinkHeads; // first rectangle with the key
+	auto& Next = Visualization.Cache.LinkNext; // next rectangle with the same UserID
+	Keys.assign(Mask + 1, 0);
+	Heads.assign(Mask + 1, None);
+	Next.resize(End2 - Begin2);
+	auto FindBucket = [&](UINT64 UserID) {
+		UINT64 Hash = UserID * 0x9E3779B97F4A7C15ull;
+		size_t Bucket = size_t(Hash ^ (Hash >> 32)) & Mask;
+		while (Heads[Bucket] != None && Keys[Bucket] != UserID) {
+			Bucket = (Bucket + 1) & Mask;
+		}
+		return Bucket;
+	};
+
+	// Chain from the back, so that each chain is in index order
+	for (size_t j = End2; j-- > Begin2; ) {
+		UINT64 UserID = Rectangles[j].Event->UserID;
+		size_t Bucket = FindBucket(UserID);
+		Keys[Bucket] = UserID;
+		Next[j - Begin2] = Heads[Bucket];
+		Heads[Bucket] = j;
+	}
+
+	for (size_t i = Begin1; i < End1; ++i) {
+		auto& R1 = Rectangles[i];
+		for (size_t j = Heads[FindBucket(R1.Event->UserID)]; j != None; j = Next[j - Begin2]) {
+			if (j < i) {
+				continue;
+			}
+			auto& R2 = Rectangles[j];
+			if ((!PrimaryOnly || (R1.Flags & R2.Flags & Rectangle::Primary)) &&
+				(!(R1.Sequence | R2.Sequence) || abs(R1.Sequence-R2.Sequence) == 1))
+			{
+				// Create lines between the two primary rectangles for this event
+				JoinTwoRectangles(Visualization.Lines, R1, R2);
+			}
+		}
+	}
+}
+
+// Rectangles are clipped to Rect. A run of events narrower than a pixel, each
+// starting within a pixel of the previous one's end, becomes one Merged
+// rectangle, so a queue firing many tiny events costs at most one rectangle
+// per pixel column instead of one per event. Events with a UserID are left
+// out of runs: ConnectTheDots links rectangles through their Event.
+void LayoutLinearQueue(std::vector<EventViz::Rectangle>& Rectangles,
+	std::vector<RectangleSummary>& Summaries,
+	LayoutCache::Lane& Lane, UINT64 StartTime, float TimeToPixels, FloatRect Rect)
+{
+	const size_t None = ~size_t(0);
+	RectangleSummary Run = { None, 0, 0, 0 }; // the narrow rectangle being merged into
+
+	auto EndRun = [&]() {
+		if (Run.Rectangle != None && Run.Count > 1) {
+			Rectangles[Run.Rectangle].Flags |= Rectangle::Merged;
+			Summaries.push_back(Run);
+		}
+		Run.Rectangle = None;
+	};
+
+	for (size_t i = Lane.Head; i < Lane.Events.size(); ++i)
+	{
+		EventData& Event = Lane.Events[i];
+		if (VisibleEnd(Event.Start, Event.End) < StartTime) {
+			continue; // scrolled out, but still behind an older, longer event
+		}
+		float X0 = Rect.Left + TimeToPixels * INT64(Event.Start - StartTime);
+		float X1 = Rect.Left + TimeToPixels * INT64(Event.End   - StartTime);
+		X0 = std::max(X0, Rect.Left);
+		X1 = std::min(X1, Rect.Right);
+		if (X1 < X0) {
+			continue;
+		}
+
+		UINT64 Duration = Event.End - Event.Start;
+		bool Narrow = X1 - X0 < kMinRectanglePixels && !Event.UserID;
+		if (Narrow && Run.Rectangle != None &&
+			X0 - Rectangles[Run.Rectangle].Right < kMinRectanglePixels)
+		{
+			auto& R = Rectangles[Run.Rectangle];
+			R.Right = std::max(R.Right, X1);
+			Run.Count += 1;
+			Run.MinDuration = std::min(Run.MinDuration, Duration);
+			Run.MaxDuration = std::max(Run.MaxDuration, Duration);
+			continue;
+		}
+
+		EndRun();
+		if (Narrow) {
+			Run = { Rectangles.size(), 1, Duration, Duration };
+		}
+		Rectangles.push_back( { X0, Rect.Top, X1, Rect.Bottom, &Event, Rectangle::Primary, 0 } );
+	}
+	EndRun();
+}
+
+void ComputeStackedQueueColumns(
+	const std::vector<EventViz::EventData*>& Events, // should be sorted by start time
+	const UINT64 *Vsyncs, int K, // should be sorted by time
+	std::vector<UINT>& Offsets, // the stack of interval i is [Offsets[i], Offsets[i+1])
+	EventSet& Stacks, // all K-1 stacks, back to back
+	UINT *MaxStackSize)
+{
+	// N * (log(K)+C)
+	// Each stack is in chronological (start time) order
+
+	// Scatter each event into every interval that it intersects. The stacks
+	// are counted first and then filled in, so they all share one array.
+
+	*MaxStackSize = 0;
+	Stacks.clear();
+	Offsets.assign(std::max(K, 1) + 1, 0);
+
+	if (K < 2) {
+		return;
+	}
+
+	// The intervals [First, Last) that an event intersects
+	auto IntervalRange = [=](EventData *Event, int *First, int *Last) {
+		auto StartTime = Event->Start;
+		auto EndTime = VisibleEnd(Event->Start, Event->End);
+		auto FirstVsyncPtr = std::lower_bound(Vsyncs, Vsyncs + K, StartTime); // First Vsync that is >= StartTime
+		auto LastVsyncPtr = std::lower_bound(Vsyncs, Vsyncs + K, EndTime); // First Vsync that is >= EndTime
+		*First = std::max(0, int(FirstVsyncPtr - Vsyncs - 1));
+		*Last = std::min(K-1, int(LastVsyncPtr - Vsyncs));
+	};
+
+	// Count into Offsets[i+2], so that after the prefix sum Offsets[i+1] is
+	// where stack i starts; filling then advances it to where stack i ends,
+	// which is where stack i+1 starts.
+	int EventCount = (int)Events.size();
+	int First, Last;
+	for (int e = 0; e < EventCount; ++e)
+	{
+		IntervalRange(Events[e], &First, &Last);
+		for (int i = First; i < Last; ++i) {
+			++Offsets[i + 2];
+		}
+	}
+	for (int i = 2; i <= K; ++i) {
+		Offsets[i] += Offsets[i - 1];
+	}
+	Stacks.resize(Offsets[K]);
+	for (int e = 0; e < EventCount; ++e)
+	{
+		auto Event = Events[e];
+		IntervalRange(Event, &First, &Last);
+		for (int i = First; i < Last; ++i)
+		{
+			assert(IntervalsIntersect(Event->Start, VisibleEnd(Event->Start, Event->End), Vsyncs[i], Vsyncs[i + 1]));
+			Stacks[Offsets[i + 1]++] = Event;
+		}
+	}
+
+	UINT BiggestStack = 0;
+	for (int i = 0; i < K-1; ++i) {
+		BiggestStack = std::max(BiggestStack, Offsets[i + 1] - Offsets[i]);
+	}
+	*MaxStackSize = BiggestStack;
+}
+
+void SequenceTable::Reset(UINT64 MinID, UINT64 MaxID, size_t Count)
+{
+	Base = MinID;
+	Dense = MaxID - MinID < 4 * Count + 64;
+	size_t Size = 16;
+	if (Dense) {
+		Size = size_t(MaxID - MinID) + 1;
+	} else {
+		while (Size < 2 * Count) {
+			Size *= 2;
+		}
+	}
+	Counts.assign(Size, 0);
+	Keys.assign(Dense ? 0 : Size, UINT64(None));
+}
+
+int& SequenceTable::operator[](UINT64 UserID)
+{
+	if (Dense) {
+		return Counts[size_t(UserID - Base)];
+	}
+	size_t Mask = Keys.size() - 1;
+	UINT64 Hash = UserID * 0x9E3779B97F4A7C15ull;
+	size_t Slot = size_t(Hash ^ (Hash >> 32)) & Mask;
+	while (Keys[Slot] != UserID && Keys[Slot] != None) {
+		Slot = (Slot + 1) & Mask;
+	}
+	Keys[Slot] = UserID;
+	return Counts[Slot];
+}
+
+void LayoutStackedQueue(
+	SequenceTable& SequenceCounter,
+	std::vector<EventViz::Rectangle>& Rectangles,
+	LayoutCache& Cache,
+	UINT64 StartTime,
+	float TimeToPixels, FloatRect Rect, UINT Rows)
+{
+	// for each interval:
+	// find all entries overlapping the interval
+	// draw them from bottom to top, least recent to most recent
+
+	for (auto& Interval : Cache.Intervals)
+	{
+		auto Stack = Cache.Stacked.data() + Interval.StackBegin;
+		// from bottom to top
+		UINT64 IntervalStart = Interval.Start;
+		UINT64 IntervalEnd = Interval.End;
+		UINT StackSize = UINT(Interval.StackEnd - Interval.StackBegin);
+		UINT Lift = Rows - StackSize;
+		for (UINT j = 0; j < StackSize; ++j) {
+			// The END of the stack contains the most recent item, which needs to go at the bottom.
+			auto Event = &Stack[StackSize-1-j];
+			auto BlockStart = std::max(Event->Start, IntervalStart);
+			auto BlockEnd = std::min(Event->End, IntervalEnd);
+			float Y0 = Rect.Bottom-(j+1+Lift)*kQueueLineHeight;
+			float Y1 = Rect.Bottom -(j+Lift)*kQueueLineHeight;
+			float X0 = Rect.Left + TimeToPixels * INT64(BlockStart - StartTime);
+			float X1 = Rect.Left + TimeToPixels * INT64(BlockEnd - StartTime);
+			int Flags = 0;
+
+			auto& SequenceIndex = SequenceCounter[Event->UserID];
+			SequenceIndex += 1;
+#if 0
+			// last rectangle before presenting is Primary
+			if (Event->End <= IntervalEnd && Event->End > IntervalStart) {
+				Flags |= Rectangle::Primary;
+			}
+#else
+			// first rectangle entering the queue is Primary
+			if (Event->Start >= IntervalStart && Event->Start <= IntervalEnd) {
+				Flags |= Rectangle::Primary;
+			}
+#endif
+			if (Event->End == UINT64_MAX) {
+				Flags |= Rectangle::Dropped;
+			}
+			Rectangles.push_back({ X0, Y0, X1, Y1, Event, Flags, SequenceIndex });
+		}
+	}
+}
+
+void LayoutDisplayRectangles(
+	SequenceTable& SequenceCounter,
+	std::vector<EventViz::Rectangle>& Rectangles,
+	LayoutCache& Cache,
+	UINT64 StartTime,
+	float TimeToPixels, FloatRect Rect)
+{
+	EventData *Display = 0;
+	int Flags = 0;
+
+	for (auto& Interval : Cache.Intervals)
+	{
+		if (Display)
+		{
+			UINT64 IntervalStart = Interval.Start;
+			UINT64 IntervalEnd = Interval.End;
+			float Y0 = Rect.Top;
+			float Y1 = Rect.Bottom;
+			float X0 = Rect.Left + TimeToPixels * INT64(IntervalStart - StartTime);
+			float X1 = Rect.Left + TimeToPixels * INT64(IntervalEnd - StartTime);
+			auto& SequenceIndex = SequenceCounter[Display->UserID];
+			SequenceIndex += 1;
+			Rectangles.push_back({ X0, Y0, X1, Y1, Display, Flags, SequenceIndex });
+			Flags = 0;
+		}
+
+		if (Interval.StackBegin != Interval.StackEnd)
+		{
+			Display = &Cache.Stacked[Interval.StackBegin];
+			Flags = Rectangle::Primary;
+		}
+	}
+}
+
+// Brings the cache up to date with the window [VsyncTimes.front(), VsyncTimes.back()].
+// Whatever starts before DirtyFrom is unchanged since the last update and is
+// kept; the rest is gathered and laid out again. Events are committed in
+// roughly chronological order, so that is usually the last interval or two.
+void UpdateLayoutCache(EventStream& Stream, const std::vector<UINT64>& VsyncTimes, LayoutCache& Cache)
+{
+	auto& Tracks = Stream.Tracks;
+	auto& Intervals = Cache.Intervals;
+	auto& Events = Cache.Events;
+	UINT64 StartTime = VsyncTimes.front();
+	UINT64 EndTime = VsyncTimes.back();
+	size_t IntervalCount = VsyncTimes.size() - 1;
+
+	// Forget what scrolled out of the window
+	UINT64 OldestStart = UINT64_MAX;
+	{
+		size_t Expired = 0;
+		while (Expired < Intervals.size() && Intervals[Expired].Start < StartTime) {
+			++Expired;
+		}
+		Intervals.erase(Intervals.begin(), Intervals.begin() + Expired);
+
+		size_t Dead = Intervals.empty() ? Cache.Stacked.size() : Intervals[0].StackBegin;
+		if (Dead >= Cache.Stacked.size() - Dead) {
+			Cache.Stacked.erase(Cache.Stacked.begin(), Cache.Stacked.begin() + Dead);
+			for (auto& Interval : Intervals) {
+				Interval.StackBegin -= Dead;
+				Interval.StackEnd -= Dead;
+			}
+		}
+	}
+	if (!Intervals.empty() && Intervals[0].StackBegin != Intervals[0].StackEnd) {
+		OldestStart = Cache.Stacked[Intervals[0].StackBegin].Start;
+	}
+	for (auto& Lane : Cache.Lanes) {
+		while (Lane.Head < Lane.Events.size() &&
+			VisibleEnd(Lane.Events[Lane.Head].Start, Lane.Events[Lane.Head].End) < StartTime)
+		{
+			++Lane.Head;
+		}
+		if (Lane.Head < Lane.Events.size()) {
+			OldestStart = std::min(OldestStart, Lane.Events[Lane.Head].Start);
+		}
+		// Same amortized compaction as the stores
+		if (Lane.Head >= Lane.Events.size() - Lane.Head) {
+			Lane.Events.erase(Lane.Events.begin(), Lane.Events.begin() + Lane.Head);
+			Lane.Head = 0;
+		}
+	}
+
+	UINT64 DirtyFrom;
+	if (Cache.Stream != &Stream ||
+		Cache.Lanes.size() != Stream.GetQueueCount() ||
+		EndTime < Cache.EndTime ||
+		Stream.GetTrimmedBefore() > OldestStart ||
+		!Stream.GetEarliestCommitSince(Cache.CommitCount, &DirtyFrom))
+	{
+		// Start over
+		Cache.Stream = &Stream;
+		Intervals.clear();
+		Cache.Stacked.clear();
+		Cache.Lanes.resize(Stream.GetQueueCount());
+		for (auto& Lane : Cache.Lanes) {
+			Lane.Head = 0;
+			Lane.Events.clear();
+		}
+		DirtyFrom = 0;
+	}
+	// Events past the previous window were never cached
+	DirtyFrom = std::min(DirtyFrom, Cache.EndTime + 1);
+
+	// PresentQ: an event reaches every interval that ends at or after its start.
+	size_t Valid = 0;
+	while (Valid < Intervals.size() && Valid < IntervalCount &&
+		Intervals[Valid].Start == VsyncTimes[Valid] &&
+		Intervals[Valid].End == VsyncTimes[Valid + 1] &&
+		Intervals[Valid].End < DirtyFrom)
+	{
+		++Valid;
+	}
+	Intervals.resize(Valid);
+	Cache.Stacked.resize(Valid ? Intervals.back().StackEnd : 0);
+	if (Valid < IntervalCount)
+	{
+		auto Vsyncs = VsyncTimes.data() + Valid;
+		int K = int(IntervalCount - Valid) + 1;
+		UINT Rows;
+		Events.clear();
+		Tracks[kPresentQueue].Events.Gather(Vsyncs[0], EndTime, Events);
+		ComputeStackedQueueColumns(Events, Vsyncs, K, Cache.StackOffsets, Cache.StackEvents, &Rows);
+
+		size_t Base = Cache.Stacked.size();
+		for (int i = 0; i < K-1; ++i) {
+			Intervals.push_back({ Vsyncs[i], Vsyncs[i + 1], Base + Cache.StackOffsets[i], Base + Cache.StackOffsets[i + 1] });
+		}
+		for (EventData *Event : Cache.StackEvents) {
+			Cache.Stacked.push_back(*Event);
+		}
+	}
+
+	// Linear queues: each lane is sorted by start time, so the events to lay
+	// out again are a suffix.
+	for (QueueID Queue = 0; Queue < Stream.GetQueueCount(); ++Queue)
+	{
+		if (Queue == kVsyncQueue || Queue == kPresentQueue) {
+			continue;
+		}
+		auto& Lane = Cache.Lanes[Queue];
+		while (Lane.Events.size() > Lane.Head && Lane.Events.back().Start >= DirtyFrom) {
+			Lane.Events.pop_back();
+		}
+		if (DirtyFrom <= EndTime)
+		{
+			Events.clear();
+			Tracks[Queue].Events.Gather(std::max(DirtyFrom, StartTime), EndTime, Events);
+			for (EventData *Event : Events) {
+				if (Event->Start >= DirtyFrom) {
+					Lane.Events.push_back(*Event);
+				}
+			}
+		}
+	}
+
+	Cache.EndTime = EndTime;
+	Cache.CommitCount = Stream.GetCommitCount();
+}
+
+void CreateVisualization(EventStream& Stream, UINT FirstVsync, UINT LastVsync, FloatRect ScreenRectInDips, EventVisualization& Visualization)
+{
+	// We have three types of visualization:
+
+	// Linear queues, Stacked queues, and Vsyncs.
+
+	// The CPU & GPU queue are linear; The Present queue is stacked.
+	// Vsyncs are represented as vertical lines.
+
+	UINT VsyncCount = Stream.GetVsyncCount();
+	if (LastVsync <= FirstVsync ||
+		FirstVsync >= VsyncCount ||
+		LastVsync >= VsyncCount)
+	{
+		Visualization.Lines.clear();
+		Visualization.Rectangles.clear();
+		Visualization.Summaries.clear();
+		return;
+	}
+
+	UINT64 StartTime = Stream.GetVsyncTime(FirstVsync);
+	UINT64 EndTime = Stream.GetVsyncTime(LastVsync);
+
+	auto& Cache = Visualization.Cache;
+	auto& VsyncTimes = Cache.VsyncTimes;
+	VsyncTimes.clear();
+	for (UINT i = FirstVsync; i <= LastVsync; ++i)
+	{
+		VsyncTimes.push_back(Stream.GetVsyncTime(i));
+	}
+
+	// The layout in time only changes where new events landed.
+	UpdateLayoutCache(Stream, VsyncTimes, Cache);
+
+	// Everything below only maps the cached layout to the screen.
+	Visualization.Lines.clear();
+	Visualization.Rectangles.clear();
+	Visualization.Summaries.clear();
+
+	// Layout from the bottom up: user-defined tracks, CpuQ, GpuQ, PresentQ
+	float y = ScreenRectInDips.Bottom;
+	FloatRect Rect;
+
+	Rect.Left = ScreenRectInDips.Left + kPaddingPixels;
+	Rect.Right = ScreenRectInDips.Right - kPaddingPixels;
+
+	UINT64 TimeWidth = EndTime - StartTime + 1;
+	float PixelWidth = Rect.Right - Rect.Left + 1;
+	float TimeToPixels = PixelWidth / TimeWidth;
+
+	// Only present and display rectangles are numbered, and they all come
+	// from the present stacks.
+	SequenceTable& SequenceCounter = Cache.Sequences;
+	{
+		UINT64 MinID = UINT64_MAX, MaxID = 0;
+		size_t Count = 0;
+		size_t Begin = Cache.Intervals.empty() ? 0 : Cache.Intervals[0].StackBegin;
+		for (size_t i = Begin; i < Cache.Stacked.size(); ++i) {
+			MinID = std::min(MinID, Cache.Stacked[i].UserID);
+			MaxID = std::max(MaxID, Cache.Stacked[i].UserID);
+			++Count;
+		}
+		SequenceCounter.Reset(std::min(MinID, MaxID), MaxID, Count);
+	}
+
+	// User-defined tracks are linear, with the first one at the bottom.
+	for (QueueID Queue = kBuiltinQueueCount; Queue < Stream.GetQueueCount(); ++Queue)
+	{
+		Rect.Top = y - kQueueLineHeight;
+		Rect.Bottom = y;
+		LayoutLinearQueue(Visualization.Rectangles, Visualization.Summaries, Cache.Lanes[Queue], StartTime, TimeToPixels, Rect);
+		y -= kQueueLineHeight + kPaddingPixels;
+	}
+
+	// CpuQ
+	size_t CpuRectBegin, CpuRectEnd;
+	{
+		Rect.Top = y - kQueueLineHeight;
+		Rect.Bottom = y;
+		CpuRectBegin = Visualization.Rectangles.size();
+		LayoutLinearQueue(Visualization.Rectangles, Visualization.Summaries, Cache.Lanes[kCpuQueue], StartTime, TimeToPixels, Rect);
+		CpuRectEnd = Visualization.Rectangles.size();
+		y -= kQueueLineHeight + kPaddingPixels;
+	}
+
+	// GpuQ
+	size_t GpuRectBegin, GpuRectEnd;
+	{
+		Rect.Top = y - kQueueLineHeight;
+		Rect.Bottom = y;
+		GpuRectBegin = Visualization.Rectangles.size();
+		LayoutLinearQueue(Visualization.Rectangles, Visualization.Summaries, Cache.Lanes[kGpuQueue], StartTime, TimeToPixels, Rect);
+		GpuRectEnd = Visualization.Rectangles.size();
+		y -= kQueueLineHeight + kPaddingPixels;
+	}
+
+	// PresentQ
+	size_t PresentRectBegin, PresentRectEnd;
+	{
+		UINT Rows = 0;
+		for (auto& Interval : Cache.Intervals) {
+			Rows = std::max(Rows, UINT(Interval.StackEnd - Interval.StackBegin));
+		}
+		Rect.Top = y - Rows*kQueueLineHeight;
+		Rect.Bottom = y;
+		PresentRectBegin = Visualization.Rectangles.size();
+		LayoutStackedQueue(SequenceCounter, Visualization.Rectangles, Cache, StartTime, TimeToPixels, Rect, Rows);
+		PresentRectEnd = Visualization.Rectangles.size();
+		y = Rect.Top - kPaddingPixels;
+	}
+	
+	// DisplayQ:
+	size_t DisplayRectBegin, DisplayRectEnd;
+	{
+		Rect.Top = y - kQueueLineHeight;
+		Rect.Bottom = y;
+		DisplayRectBegin = Visualization.Rectangles.size();
+		LayoutDisplayRectangles(SequenceCounter, Visualization.Rectangles, Cache, StartTime, TimeToPixels, Rect);
+		DisplayRectEnd = Visualization.Rectangles.size();
+	}
+	ConnectTheDots(Visualization, CpuRectBegin, CpuRectEnd, GpuRectBegin, GpuRectEnd, true);
+	//ConnectTheDots(Visualization, GpuRectBegin, GpuRectEnd, PresentRectBegin, PresentRectEnd, true);
+
+	ConnectTheDots(Visualization, CpuRectBegin, CpuRectEnd, PresentRectBegin, PresentRectEnd, true);
+	ConnectTheDots(Visualization, PresentRectBegin, PresentRectEnd, PresentRectBegin, PresentRectEnd, false);
+	ConnectTheDots(Visualization, PresentRectBegin, PresentRectEnd, DisplayRectBegin, DisplayRectEnd, false);
+
+	// Vsyncs
+	{
+		float Y0 = Rect.Top;
+		float Y1 = ScreenRectInDips.Bottom;
+		for (size_t i = 0; i < VsyncTimes.size(); ++i)
+		{
+			float X0 = Rect.Left + TimeToPixels * (VsyncTimes[i] - StartTime);
+			Visualization.Lines.push_back({ X0, Y0, X0, Y1 });
+		}
+	}
+}
+
+/// ----------------------------------------------------------------------
+///                             Layout worker
+/// ----------------------------------------------------------------------
+
+LayoutWorker::LayoutWorker()
+	: Ready(new Result)
+	, Front(new Result)
+	, Back(new Result)
+	, Thread(&LayoutWorker::Run, this)
+{
+
+}
+
+LayoutWorker::~LayoutWorker()
+{
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		Quit = true;
+	}
+	Wake.notify_one();
+	Thread.join();
+}
+
+void LayoutWorker::Submit(EventStream& Stream, UINT FirstVsync, UINT LastVsync, FloatRect Screen)
+{
+	// A new stream is copied whole, and followed from then on
+	bool StartOver = Sink.GetStream() != &Stream;
+	if (StartOver) {
+		Sink.Attach(Stream);
+		Sink.Records.clear();
+		Snapshot.clear();
+		Stream.GetAllEvents(Snapshot);
+	}
+
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+
+		if (StartOver) {
+			// What the worker has not taken yet was for the old stream
+			std::swap(Records, Snapshot);
+			Reset = true;
+		}
+		if (Records.empty()) {
+			std::swap(Records, Sink.Records);
+		} else {
+			Records.insert(Records.end(), Sink.Records.begin(), Sink.Records.end());
+		}
+		Sink.Records.clear();
+
+		QueueNames.resize(Stream.GetQueueCount());
+		for (QueueID Queue = 0; Queue < Stream.GetQueueCount(); ++Queue) {
+			QueueNames[Queue] = Stream.GetQueueName(Queue);
+		}
+		HistoryCapacity = Stream.HistoryCapacity;
+		this->FirstVsync = FirstVsync;
+		this->LastVsync = LastVsync;
+		this->Screen = Screen;
+		++Submitted;
+	}
+	Wake.notify_one();
+}
+
+const EventVisualization *LayoutWorker::AcquireLatest()
+{
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		if (Ready->Submission > Front->Submission) {
+			std::swap(Ready, Front);
+		}
+	}
+	return Front->Submission ? &Front->Visualization : nullptr;
+}
+
+void LayoutWorker::Wait()
+{
+	std::unique_lock<std::mutex> Guard(Lock);
+	Finished.wait(Guard, [this] { return Done == Submitted; });
+}
+
+void LayoutWorker::Run()
+{
+	std::unique_lock<std::mutex> Guard(Lock);
+	for (;;)
+	{
+		Wake.wait(Guard, [this] { return Quit || Done != Submitted; });
+		if (Quit) {
+			return;
+		}
+
+		// Take everything submitted so far
+		bool StartOver = Reset;
+		Reset = false;
+		Replaying.clear();
+		std::swap(Replaying, Records);
+		UINT64 Submission = Submitted;
+		UINT First = FirstVsync, Last = LastVsync;
+		FloatRect Rect = Screen;
+		if (StartOver || !Replica) {
+			Replica.reset(new EventStream);
+			Replica->Pause(false);
+			Work.Cache.Stream = 0; // the new one may be at the same address
+		}
+		for (auto& Name : QueueNames) {
+			Replica->RegisterQueue(Name.c_str());
+		}
+		Replica->SetHistoryCapacity(HistoryCapacity);
+
+		Guard.unlock();
+		Replica->Replay(Replaying);
+		CreateVisualization(*Replica, First, Last, Rect, Work);
+		Detach(Work, *Back);
+		Back->Submission = Submission;
+		Guard.lock();
+
+		std::swap(Back, Ready);
+		Done = Submission;
+		Finished.notify_all();
+	}
+}
+
+void LayoutWorker::Detach(const EventVisualization& Laid, Result& Out)
+{
+	auto& Visualization = Out.Visualization;
+	Visualization.Lines = Laid.Lines;
+	Visualization.Rectangles = Laid.Rectangles;
+	Visualization.Summaries = Laid.Summaries;
+
+	Out.Events.resize(Laid.Rectangles.size());
+	for (size_t i = 0; i < Out.Events.size(); ++i) {
+		Out.Events[i] = *Laid.Rectangles[i].Event;
+		Visualization.Rectangles[i].Event = &Out.Events[i];
+	}
+}
+
+}
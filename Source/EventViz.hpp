@@ -1,96 +1,554 @@
-////////////////////////////////////////////////////////////////////////////////
-// Copyright 2017 Intel Corporation
-//
-// Licensed under the Apache License, Version 2.0 (the "License"); you may not
-// use this file except in compliance with the License.  You may obtain a copy
-// of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
-// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
-// License for the specific language governing permissions and limitations
-// under the License.
-////////////////////////////////////////////////////////////////////////////////
-#pragma once
-
-#include "WindowsHelpers.hpp"
-#include <vector>
-#include <deque>
-#include <memory>
-
-#include "timeline_multimap.hpp"
-
-namespace EventViz
-{
-	extern const char *kVsyncQueue;
-	extern const char *kPresentQueue;
-	extern const char *kGpuQueue;
-	extern const char *kCpuQueue;
-
-	struct EventData
-	{
-		const char *Queue;
-		const void *UserData;
-		UINT64 UserID;
-		UINT64 Start;
-		UINT64 End;
-	};
-
-	typedef timeline_multimap<UINT64, std::unique_ptr<EventData>> EventMapT;
-	typedef std::vector<EventData*> EventSet;
-	typedef std::pair<int, int> VectorRange;
-	typedef std::vector<VectorRange> Partition;
-
-	struct EventStream
-	{
-		EventStream();
-		~EventStream();
-
-		void Pause(bool paused) { this->paused = paused; }
-
-		void Trim(UINT64 MaxStartTime);
-		void TrimToLastNSeconds(UINT Seconds);
-		void TrimToLastNVsyncs(UINT Vsyncs);
-
-		EventData *Start(const char *Queue, const void *UserData = 0, UINT64 UserID = 0, UINT64 Time = 0);
-		void End(EventData *Data, UINT64 Time = 0);
-		void InsertEvent(const char *Queue, UINT64 StartTime, UINT64 EndTime, const void *UserData = 0, UINT64 UserID = 0);
-		void Vsync(UINT64 Time = 0);
-
-		UINT GetVsyncCount();
-
-		EventMapT AllEvents; // keyed on/sorted by start time.
-		std::deque<EventData*> Vsyncs;
-		bool paused;
-	};
-
-	struct Line {
-		float X0, Y0, X1, Y1;
-	};
-
-	struct FloatRect {
-		float Left, Top, Right, Bottom;
-	};
-
-	struct Rectangle {
-		float Left, Top, Right, Bottom;
-		EventData *Event;
-		int Flags;
-		int Sequence;
-
-		enum FlagBits {
-			Primary = 1,
-			Dropped = 2,
-		};
-	};
-
-	struct EventVisualization {
-		std::vector<Line> Lines;
-		std::vector<Rectangle> Rectangles;
-	};
-
-	void CreateVisualization(EventStream& Stream, UINT FirstVsync,
-		UINT LastVsync, FloatRect Screen, EventVisualization& Visualization);
-}
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WindowsHelpers.hpp"
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "timeline_multimap.hpp"
+
+// Selects the backing store for completed events:
+// 0 - EventTimeline: a timeline of pointers into the EventPool.
+// 1 - EventColumns: parallel arrays sorted by start time.
+#ifndef EVENTVIZ_COLUMNAR_STORE
+#define EVENTVIZ_COLUMNAR_STORE 0
+#endif
+
+namespace EventViz
+{
+	// Queues are registered once with EventStream::RegisterQueue and then
+	// referred to by a small integer ID. The built-in queues are always
+	// registered, in this order; user-defined tracks follow them.
+	typedef UINT QueueID;
+
+	enum : QueueID {
+		kVsyncQueue,
+		kPresentQueue,
+		kGpuQueue,
+		kCpuQueue,
+		kBuiltinQueueCount,
+	};
+
+	struct EventData
+	{
+		QueueID Queue;
+		const void *UserData;
+		UINT64 UserID;
+		UINT64 Start;
+		UINT64 End;
+	};
+
+	// Refers to an event started with EventStream::Start: the index of its
+	// slot in the low 32 bits and the generation of the slot in the high 32.
+	// A slot's generation is odd while its event is pending and changes
+	// whenever the event ends or is trimmed, so a stale handle matches
+	// nothing, even once the slot holds another event. 0 is never handed out.
+	typedef UINT64 EventHandle;
+
+	// Chunked slab for EventData records.
+	// Records never move once allocated, so a timeline can point at them
+	// until they are trimmed. Freed records are threaded onto an intrusive
+	// free list and reused before a new chunk is allocated, so recording at
+	// a steady rate does not touch the heap.
+	struct EventPool
+	{
+		EventPool();
+
+		EventData *Allocate();
+		void Free(EventData *Data);
+
+		size_t GetCapacity() const { return Chunks.size() * kChunkSize; }
+		size_t GetLiveCount() const { return LiveCount; }
+
+	private:
+		enum : size_t {
+			kChunkSize = 1024, // records per chunk
+		};
+
+		union Slot
+		{
+			EventData Data;
+			Slot *Next;
+		};
+
+		std::vector<std::unique_ptr<Slot[]>> Chunks;
+		Slot *FreeList;
+		size_t LiveCount;
+	};
+
+	// Dropped presents never leave the queue (End == UINT64_MAX); for layout
+	// and window queries they only occupy their start time.
+	inline UINT64 VisibleEnd(UINT64 Start, UINT64 End)
+	{
+		return End == UINT64_MAX ? Start : End;
+	}
+
+	// Events are kept apart by duration class: class 0 holds the events
+	// shorter than 2^14 ticks (1.6ms at the usual 10MHz), class k > 0 those
+	// at least 2^(13+k) and less than 2^(14+k) ticks long. An event that
+	// reaches a window starts at most the longest duration of its class
+	// before it, so each class is searched from there: besides what it
+	// returns, the search of class k > 0 only visits events of that margin
+	// that are at least half as long as it, and the search of class 0 the
+	// short events of the 1.6ms before the window. A long event thus costs a
+	// visit to the few events of its own class, not to everything under it.
+	// Short events are not split up any further, since merging the matches
+	// of many busy classes back together would cost more than it saves.
+	enum : UINT {
+		kShortDurationBits = 14,
+		kDurationClasses = 64 - kShortDurationBits + 1,
+	};
+	UINT GetDurationClass(UINT64 Start, UINT64 End);
+	UINT64 GetMaxDuration(UINT Class);
+
+	typedef timeline_multimap<UINT64, EventData*> EventMapT;
+	typedef std::vector<EventData*> EventSet;
+	typedef std::pair<int, int> VectorRange;
+	typedef std::vector<VectorRange> Partition;
+
+	// Both stores hold completed events only, keyed on/sorted by start time
+	// within each duration class. Insert copies the event in.
+	// Trimming old events only advances a head index, so it does not depend
+	// on how much history is kept.
+	// Gather appends exactly the events whose [Start, VisibleEnd] intersects
+	// [StartTime, EndTime], in start order: the matches of the classes are
+	// merged, through scratch space kept by the store.
+	// GetStart(0) is the earliest start of all; other indices are only quick
+	// when every event has the same class, as vsyncs do.
+
+	// Row store: the records live in a pool of the timeline's own and the
+	// timeline points at them.
+	struct EventTimeline
+	{
+		void Insert(const EventData& Event);
+		void Trim(UINT64 MaxStartTime);
+		void TrimToSize(size_t MaxCount); // keeps the MaxCount most recent
+		void Gather(UINT64 StartTime, UINT64 EndTime, EventSet& Events);
+		bool Empty() { return Count == 0; }
+		size_t Size() { return Count; }
+		UINT64 GetStart(size_t Index);
+
+		enum : size_t {
+			kBytesPerEvent = sizeof(EventData) + sizeof(EventMapT::value_type), // pool record and entry
+		};
+
+		EventPool Pool;
+		EventMapT Classes[kDurationClasses]; // by duration class
+
+	private:
+		size_t Count = 0;
+		UINT ClassCount = 0; // classes from here on have never been used
+		std::vector<size_t> Runs; // Gather scratch
+		EventSet MergeScratch;
+	};
+
+	// Column store: each record is copied into parallel arrays, so window
+	// queries sweep contiguous memory instead of chasing a pointer per event.
+	// Gather materializes its matches into scratch rows owned by the store,
+	// which stay valid until the next Insert or Gather.
+	struct EventColumns
+	{
+		void Insert(const EventData& Event);
+		void Trim(UINT64 MaxStartTime);
+		void TrimToSize(size_t MaxCount); // keeps the MaxCount most recent
+		void Gather(UINT64 StartTime, UINT64 EndTime, EventSet& Events);
+		bool Empty() { return Count == 0; }
+		size_t Size() { return Count; }
+		UINT64 GetStart(size_t Index);
+
+		enum : size_t {
+			kBytesPerEvent = 3 * sizeof(UINT64) + sizeof(const void*), // a row of the columns
+		};
+
+		// The rows of one duration class
+		struct Columns
+		{
+			size_t Head = 0; // rows before Head have been trimmed
+			std::vector<UINT64> Start;
+			std::vector<UINT64> End;
+			std::vector<UINT64> UserID;
+			std::vector<const void*> UserData;
+			std::vector<EventData> Unsorted; // committed since the last Sort()
+
+			size_t Size() { return Start.size() - Head + Unsorted.size(); }
+		};
+
+		QueueID Queue; // every row belongs to this queue
+		Columns Classes[kDurationClasses]; // by duration class
+
+	private:
+		void Sort(Columns& C);
+		void Compact(Columns& C);
+		void Resize(Columns& C, size_t Count);
+		void SetRow(Columns& C, size_t Index, const EventData& Row);
+		EventData GetRow(Columns& C, size_t Index);
+
+		size_t Count = 0;
+		UINT ClassCount = 0; // classes from here on have never been used
+		std::vector<EventData> MergeScratch;
+		std::vector<EventData> Rows; // Gather output
+		std::vector<UINT> Selected;
+		std::vector<size_t> Runs;
+	};
+
+#if EVENTVIZ_COLUMNAR_STORE
+	typedef EventColumns EventStoreT;
+#else
+	typedef EventTimeline EventStoreT;
+#endif
+
+	struct EventRecorder;
+	struct CommitSink;
+
+	struct EventStream
+	{
+		EventStream();
+		~EventStream();
+
+		void Pause(bool paused) { this->paused = paused; }
+
+		// Returns the ID of the queue with this name, registering it if needed.
+		// The stream keeps a copy of the name. What GetQueueName returns is
+		// valid until the next RegisterQueue.
+		QueueID RegisterQueue(const char *Name);
+		const char *GetQueueName(QueueID Queue) { return Tracks[Queue].Name.c_str(); }
+		UINT GetQueueCount() { return (UINT)Tracks.size(); }
+
+		void Trim(UINT64 MaxStartTime);
+		void TrimToLastNSeconds(UINT Seconds);
+		void TrimToLastNVsyncs(UINT Vsyncs);
+
+		// Bounds the history of each queue to the given number of events, or
+		// to the events that fit in the given number of bytes of its store
+		// (EventStoreT::kBytesPerEvent each); 0 means unbounded. The bound is
+		// kept as events are committed: the oldest event of a full queue is
+		// trimmed to make room. Trimmed storage is reclaimed lazily, so a
+		// store may hold on to up to as much again.
+		void SetHistoryCapacity(size_t EventsPerQueue) { HistoryCapacity = EventsPerQueue; }
+		void SetHistoryBytes(size_t BytesPerQueue);
+
+		// Start returns 0 while paused. End does nothing for 0, or for an
+		// event that has already ended or has been trimmed; either way it
+		// takes constant time.
+		EventHandle Start(QueueID Queue, const void *UserData = 0, UINT64 UserID = 0, UINT64 Time = 0);
+		void End(EventHandle Handle, UINT64 Time = 0);
+		void InsertEvent(QueueID Queue, UINT64 StartTime, UINT64 EndTime, const void *UserData = 0, UINT64 UserID = 0);
+		void Vsync(UINT64 Time = 0);
+
+		// Merges everything recorded by EventRecorders into the timelines.
+		// Call it from the thread that owns the stream, before laying it out.
+		void Flush();
+
+		UINT GetVsyncCount();
+		UINT64 GetVsyncTime(UINT Index); // Index 0 is the oldest vsync kept
+
+		// Lets incremental readers (see LayoutCache) find out what changed
+		// since they last looked. Commits are numbered, and the most recent
+		// ones are kept in a ring. Trims are logged too, as records of queue
+		// kTrimRecord with Start set to the time trimmed to, so that replaying
+		// the log (see Replay) leaves a copy of the stream in the same state.
+		// Readers that must not miss any record, however many come between two
+		// looks, take them from a CommitSink instead.
+		UINT64 GetCommitCount() { return CommitCount; }
+		bool GetEarliestCommitSince(UINT64 Count, UINT64 *EarliestStart); // false once the ring has moved past Count
+		bool GetCommitsSince(UINT64 Count, std::vector<EventData>& Records); // appends; false once the ring has moved past Count
+		UINT64 GetTrimmedBefore() { return TrimmedBefore; } // events that started earlier may have been trimmed
+
+		// Appends every completed event kept, queue by queue, for Replay
+		// into a new stream.
+		void GetAllEvents(std::vector<EventData>& Records);
+		void Replay(const std::vector<EventData>& Records);
+
+		// Events started but not yet ended, in slots that are reused
+		struct PendingSlot
+		{
+			EventData Event;
+			UINT Generation = 0; // odd while Event is pending
+		};
+		std::vector<PendingSlot> Pending;
+		std::vector<UINT> FreePending; // indices of the slots not in use
+		void ReleasePending(UINT Index);
+
+		struct Track
+		{
+			std::string Name;
+			EventStoreT Events; // keyed on/sorted by start time.
+		};
+		std::vector<Track> Tracks; // indexed by QueueID
+		size_t HistoryCapacity;
+		void TrimToCapacity(Track& Track);
+		bool paused;
+
+		enum : size_t {
+			kCommitLogSize = 4096, // power of 2
+		};
+		enum : QueueID {
+			kTrimRecord = ~QueueID(0),
+		};
+		void Commit(const EventData& Event); // hands a completed event to its track
+		void Log(const EventData& Record); // to the ring and to every sink
+		UINT64 CommitCount;
+		std::vector<EventData> CommitLog; // commit i is at i % kCommitLogSize
+		UINT64 TrimmedBefore;
+		std::vector<CommitSink*> Sinks;
+
+		// Guards Recorders and Orphans; recording itself never takes it.
+		std::mutex RecordersLock;
+		std::vector<EventRecorder*> Recorders;
+		std::vector<EventData> Orphans; // left over by destroyed recorders
+	};
+
+	// Receives every record the commit log of a stream gets from Attach on,
+	// commits and trims alike, in Records, which grows until the reader takes
+	// them: unlike the ring, a sink cannot be lapped however long the reader
+	// takes. Replaying GetAllEvents as of Attach and then the records leaves a
+	// copy of the stream in the same state. Attach, Detach and the records
+	// belong to the thread that owns the stream. A sink detaches from its
+	// stream when either of them is destroyed.
+	struct CommitSink
+	{
+		CommitSink() = default;
+		~CommitSink() { Detach(); }
+		CommitSink(const CommitSink&) = delete;
+		CommitSink& operator=(const CommitSink&) = delete;
+
+		void Attach(EventStream& Stream); // detaches from the previous stream first
+		void Detach();
+		EventStream *GetStream() { return Stream; }
+
+		std::vector<EventData> Records; // in commit order; the reader clears them
+
+	private:
+		EventStream *Stream = 0;
+	};
+
+	// Records events on a thread other than the one that owns the stream.
+	// Each recorder is a single-producer/single-consumer ring: its thread
+	// pushes completed events without locking and EventStream::Flush drains
+	// them. When the ring is full new events are dropped and counted.
+	// Queues must be registered on the owning thread before they are used.
+	// The stream must outlive its recorders: a recorder unregisters itself,
+	// and hands over what it has not flushed yet, when it is destroyed.
+	// Start hands out a record of the recorder's own, which only its thread
+	// sees, so unlike EventStream::End, End has nothing to look up; the
+	// pointer must be ended exactly once.
+	struct EventRecorder
+	{
+		EventRecorder(EventStream& Stream, UINT Capacity = 4096); // Capacity is rounded up to a power of 2
+		~EventRecorder();
+
+		EventData *Start(QueueID Queue, const void *UserData = 0, UINT64 UserID = 0, UINT64 Time = 0);
+		void End(EventData *Data, UINT64 Time = 0);
+		void InsertEvent(QueueID Queue, UINT64 StartTime, UINT64 EndTime, const void *UserData = 0, UINT64 UserID = 0);
+
+		UINT64 GetDroppedCount() { return Dropped.load(std::memory_order_relaxed); }
+
+	private:
+		friend struct EventStream;
+
+		void Push(const EventData& Event);
+		bool Pop(EventData *Event);
+
+		EventStream& Stream;
+		EventPool Open; // started events, only touched by the recording thread
+		std::vector<EventData> Ring;
+		size_t Mask;
+		std::atomic<size_t> WriteIndex; // advanced by the recording thread
+		std::atomic<size_t> ReadIndex; // advanced by EventStream::Flush
+		std::atomic<UINT64> Dropped;
+	};
+
+	struct Line {
+		float X0, Y0, X1, Y1;
+	};
+
+	struct FloatRect {
+		float Left, Top, Right, Bottom;
+	};
+
+	struct Rectangle {
+		float Left, Top, Right, Bottom;
+		EventData *Event;
+		int Flags;
+		int Sequence;
+
+		enum FlagBits {
+			Primary = 1,
+			Dropped = 2,
+			Merged = 4, // stands for several events, see RectangleSummary
+		};
+	};
+
+	// Linear queue events narrower than a pixel that follow each other within
+	// a pixel are drawn as one Merged rectangle, whose Event is the first of
+	// them. This is what it stands for. Events with a UserID are never merged,
+	// so that every event that can be linked keeps a rectangle of its own.
+	// The sample draws a Merged rectangle like any other; the summaries are
+	// for tools that report what it hides, like eviz_cli's JSON output.
+	struct RectangleSummary {
+		size_t Rectangle; // index in Rectangles
+		UINT Count; // events merged
+		UINT64 MinDuration, MaxDuration;
+	};
+
+	// Number of rectangles laid out so far for each UserID in the window.
+	// Render IDs are handed out in order, so the IDs in a window are nearly
+	// consecutive and the counts go in an array indexed from the smallest one.
+	// If the IDs are too spread out for that, they go in a hash table instead.
+	struct SequenceTable
+	{
+		void Reset(UINT64 MinID, UINT64 MaxID, size_t Count); // clears the counts
+		int& operator[](UINT64 UserID);
+
+	private:
+		enum : UINT64 {
+			None = UINT64_MAX, // UserIDs are never this large
+		};
+
+		bool Dense = true;
+		UINT64 Base = 0;
+		std::vector<int> Counts;
+		std::vector<UINT64> Keys;
+	};
+
+	// The layout of the window in time, kept from one CreateVisualization to
+	// the next. Each call drops the intervals that scrolled out, re-lays out
+	// only the intervals touched by events committed since the previous call,
+	// and then maps the whole thing to pixels with one scale and offset.
+	// Events are copied in, so the cache does not depend on the store keeping
+	// its records in place. The present stacks of all intervals share one
+	// array, in interval order. Nothing is freed when the window scrolls, and the
+	// scratch space of each call is kept too, so once the window is full a
+	// steady stream of events lays out without touching the heap.
+	struct LayoutCache
+	{
+		struct Interval
+		{
+			UINT64 Start, End; // the vsyncs around it
+			size_t StackBegin, StackEnd; // presents queued during it, oldest first, in Stacked
+		};
+
+		struct Lane
+		{
+			size_t Head = 0; // events before Head have scrolled out
+			std::vector<EventData> Events; // sorted by start time
+		};
+
+		EventStream *Stream = 0;
+		UINT64 CommitCount = 0; // of Stream, when the cache was last updated
+		UINT64 EndTime = 0; // last vsync covered
+		std::vector<Interval> Intervals; // stacked queue, one per vsync interval
+		std::vector<EventData> Stacked; // the stacks of all intervals, back to back
+		std::vector<Lane> Lanes; // linear queues, by QueueID
+
+		// Scratch
+		std::vector<UINT64> VsyncTimes;
+		EventSet Events;
+		std::vector<UINT> StackOffsets;
+		EventSet StackEvents;
+		SequenceTable Sequences;
+		std::vector<UINT64> LinkKeys;
+		std::vector<size_t> LinkHeads;
+		std::vector<size_t> LinkNext;
+	};
+
+	struct EventVisualization {
+		std::vector<Line> Lines;
+		std::vector<Rectangle> Rectangles;
+		std::vector<RectangleSummary> Summaries;
+		LayoutCache Cache;
+	};
+
+	// Keep the same Visualization from frame to frame: only the events that
+	// changed since the previous call are laid out again.
+	void CreateVisualization(EventStream& Stream, UINT FirstVsync,
+		UINT LastVsync, FloatRect Screen, EventVisualization& Visualization);
+
+	// Runs CreateVisualization on a thread of its own, so that laying out the
+	// timeline does not take time from the thread being measured.
+	// The worker keeps a copy of the stream. Submit hands it what its
+	// CommitSink collected since the previous Submit, which is cheap, and
+	// wakes it up; it never waits for the layout. Submits that come while the
+	// worker is busy are laid out together in its next pass. The copy is only
+	// rebuilt from scratch when Submit is given another stream, from a
+	// snapshot taken before the lock.
+	// Finished layouts are copied out with the events they point to, so they
+	// do not depend on either stream. They are triple buffered: the worker
+	// fills one, another waits to be picked up, and the caller draws the
+	// third.
+	// Submit and AcquireLatest belong to the thread that owns the stream.
+	struct LayoutWorker
+	{
+		LayoutWorker();
+		~LayoutWorker(); // waits for the pass in progress, if any
+
+		// FirstVsync and LastVsync are indices in Stream, as for CreateVisualization
+		void Submit(EventStream& Stream, UINT FirstVsync, UINT LastVsync, FloatRect Screen);
+
+		// The last layout finished, or null before the first one. It stays
+		// valid, and unchanged, until the next call.
+		const EventVisualization *AcquireLatest();
+
+		// Blocks until everything submitted so far is laid out
+		void Wait();
+
+	private:
+		struct Result
+		{
+			EventVisualization Visualization; // only Lines, Rectangles and Summaries are used
+			std::vector<EventData> Events; // what Visualization.Rectangles point to
+			UINT64 Submission = 0;
+		};
+
+		void Run();
+		void Detach(const EventVisualization& Laid, Result& Out);
+
+		std::mutex Lock;
+		std::condition_variable Wake; // the worker waits on it for work
+		std::condition_variable Finished; // Wait() waits on it
+
+		// Guarded by Lock
+		std::vector<EventData> Records; // to replay into Replica
+		bool Reset = true; // Replica has to start over from Records
+		std::vector<std::string> QueueNames;
+		size_t HistoryCapacity = 0;
+		UINT FirstVsync = 0, LastVsync = 0;
+		FloatRect Screen = {};
+		UINT64 Submitted = 0, Done = 0;
+		std::unique_ptr<Result> Ready;
+		bool Quit = false;
+
+		// Owning thread only
+		CommitSink Sink; // attached to the stream last submitted
+		std::vector<EventData> Snapshot; // of a newly submitted stream
+		std::unique_ptr<Result> Front;
+
+		// Worker thread only
+		std::unique_ptr<EventStream> Replica;
+		EventVisualization Work;
+		std::unique_ptr<Result> Back;
+		std::vector<EventData> Replaying;
+
+		std::thread Thread; // last, so it starts once everything else is constructed
+	};
+}
@@ -0,0 +1,269 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WindowsHelpers.hpp"
+#include <cstdio>
+#include <deque>
+
+// How one present was paced, in the terms PresentMon uses.
+struct FramePacingRecord
+{
+	UINT PresentID;
+	UINT SyncInterval;
+	BOOL Dropped;
+	double TimeInSeconds; // when Present() was called, since the first present
+	double MsBetweenPresents; // since the previous Present() call
+	double MsInPresentAPI;
+	double MsUntilDisplayed; // from the Present() call to the vsync that showed it; 0 if dropped
+	double MsBetweenDisplayChange; // from the previous frame shown to this one; 0 if dropped or the first
+	double MsDisplayed; // how long it stayed on screen; 0 if dropped or the last one shown
+	UINT RefreshesDisplayed; // how many vsyncs it stayed on screen for
+	UINT MissedRefreshes; // of those, the ones beyond its sync interval: the next frame was late
+	UINT QueueDepth; // presents waiting to be shown right after this one, itself included
+};
+
+// Turns the entries PresentQueueStats dequeues into FramePacingRecords, in
+// order, as it goes. A frame's record is complete once the next frame is
+// shown, so Emit gets each one then (with the dropped ones in between), and
+// memory only holds the presents since the last frame shown.
+//
+// Presents PresentQueueStats skips (see EntryErrorCounts) are not seen, and
+// as it takes each GetFrameStatistics call to show only its PresentCount, the
+// presents before that are dropped here too.
+struct FramePacingAnalyzer
+{
+	// Over the records emitted so far
+	struct Totals
+	{
+		UINT64 Presents;
+		UINT64 Displayed;
+		UINT64 Dropped;
+		UINT64 MissedRefreshes;
+		UINT64 QueueDepthSum;
+		UINT MaxQueueDepth;
+	};
+
+	FramePacingAnalyzer()
+		: mStarted(false), mShown(false), mHasDisplayTime(false), mFirstSyncRefreshCount(0), mFirstSyncTime(0),
+		mRefreshPeriod(0), mStartTime(0), mLastPresentCallTime(0), mLastGoneID(0), mTotals()
+	{
+	}
+
+	// Entry is a PresentQueueStats<>::QueueEntry, Emit a functor taking a
+	// const FramePacingRecord&.
+	template<class QueueEntry, class Emit>
+	void AddPresent(const QueueEntry& Entry, Emit emit)
+	{
+		UINT64 PresentCallTime = Entry.PresentCallTime ? Entry.PresentCallTime : Entry.QueueEnteredTime;
+		if (!mStarted) {
+			mStarted = true;
+			mStartTime = PresentCallTime;
+			mLastPresentCallTime = PresentCallTime;
+			mLastGoneID = Entry.PresentID - 1;
+		}
+
+		FramePacingRecord Record = {};
+		Record.PresentID = Entry.PresentID;
+		Record.SyncInterval = Entry.SyncInterval;
+		Record.Dropped = Entry.Dropped;
+		Record.TimeInSeconds = QpcTimeToSeconds(PresentCallTime - mStartTime);
+		Record.MsBetweenPresents = ToMs(PresentCallTime, mLastPresentCallTime);
+		Record.MsInPresentAPI = ToMs(Entry.QueueEnteredTime, PresentCallTime);
+		Record.QueueDepth = GetQueueDepth(Entry.PresentID, Entry.QueueEnteredTime);
+		mLastPresentCallTime = PresentCallTime;
+
+		if (Entry.Dropped)
+		{
+			mPending.push_back(Record);
+			if (!mShown) {
+				EmitPending(emit);
+			}
+			return;
+		}
+
+		UpdateRefreshPeriod(Entry.SyncRefreshCount, Entry.QueueExitedTime);
+		ShownPresent Shown = { PresentCallTime, Entry.QueueExitedTime,
+			int(Entry.SyncRefreshCount - Entry.PresentRefreshCount), Entry.PresentRefreshCount };
+		UINT64 DisplayTime = GetDisplayTime(Shown);
+		if (mShown)
+		{
+			UINT64 PreviousDisplayTime = CompleteShown(DisplayTime);
+			auto& Previous = mPending.front();
+			int Refreshes = int(Entry.PresentRefreshCount - mLastShown.PresentRefreshCount);
+			Previous.RefreshesDisplayed = Refreshes > 0 ? UINT(Refreshes) : 0;
+			UINT Expected = Previous.SyncInterval ? Previous.SyncInterval : 1;
+			Previous.MissedRefreshes = Previous.RefreshesDisplayed > Expected ? Previous.RefreshesDisplayed - Expected : 0;
+			Previous.MsDisplayed = ToMs(DisplayTime, PreviousDisplayTime);
+			EmitPending(emit);
+		}
+
+		mShown = true;
+		mLastShown = Shown;
+		mDisplayed.push_back(DisplayedPresent{ Entry.PresentID, DisplayTime });
+		mPending.push_back(Record);
+	}
+
+	// Emits what is still waiting for the next frame to be shown, without
+	// its display duration; call once presenting is over.
+	template<class Emit>
+	void Flush(Emit emit)
+	{
+		if (mShown) {
+			CompleteShown(GetDisplayTime(mLastShown));
+			mShown = false;
+		}
+		EmitPending(emit);
+	}
+
+	const Totals& GetTotals() const
+	{
+		return mTotals;
+	}
+
+private:
+
+	struct DisplayedPresent
+	{
+		UINT PresentID;
+		UINT64 DisplayTime;
+	};
+
+	struct ShownPresent
+	{
+		UINT64 PresentCallTime;
+		UINT64 SyncTime; // QueueExitedTime
+		int LateRefreshes; // SyncRefreshCount - PresentRefreshCount
+		UINT PresentRefreshCount;
+	};
+
+	static double ToMs(UINT64 Time, UINT64 Since)
+	{
+		return 1000 * (double(INT64(Time - Since)) / g_QpcFreq);
+	}
+
+	// Measured between the first frame statistics and the latest ones
+	void UpdateRefreshPeriod(UINT SyncRefreshCount, UINT64 SyncTime)
+	{
+		if (!mFirstSyncTime) {
+			mFirstSyncRefreshCount = SyncRefreshCount;
+			mFirstSyncTime = SyncTime;
+		}
+		int Refreshes = int(SyncRefreshCount - mFirstSyncRefreshCount);
+		if (Refreshes > 0) {
+			mRefreshPeriod = double(SyncTime - mFirstSyncTime) / Refreshes;
+		}
+	}
+
+	// QueueExitedTime is the time of the vsync the statistics were read at,
+	// which can be a few after the one that showed the frame: go back by the
+	// refresh period. Until there is one, that is the best guess.
+	UINT64 GetDisplayTime(const ShownPresent& Shown) const
+	{
+		if (Shown.LateRefreshes <= 0 || !mRefreshPeriod) {
+			return Shown.SyncTime;
+		}
+		return Shown.SyncTime - UINT64(Shown.LateRefreshes * mRefreshPeriod + 0.5);
+	}
+
+	// The last frame shown is replaced on screen: work out when it was shown
+	// with what is known now, which only the first one needs.
+	UINT64 CompleteShown(UINT64 NextDisplayTime)
+	{
+		UINT64 DisplayTime = GetDisplayTime(mLastShown);
+		DisplayTime = DisplayTime < NextDisplayTime ? DisplayTime : NextDisplayTime;
+		auto& Record = mPending.front();
+		Record.MsUntilDisplayed = ToMs(DisplayTime, mLastShown.PresentCallTime);
+		Record.MsBetweenDisplayChange = mHasDisplayTime ? ToMs(DisplayTime, mLastDisplayTime) : 0;
+		if (!mDisplayed.empty() && mDisplayed.back().PresentID == Record.PresentID) {
+			mDisplayed.back().DisplayTime = DisplayTime;
+		}
+		mHasDisplayTime = true;
+		mLastDisplayTime = DisplayTime;
+		return DisplayTime;
+	}
+
+	// Presents up to the last one shown before QueueEnteredTime have left the
+	// queue, shown or dropped; the others are still in it.
+	UINT GetQueueDepth(UINT PresentID, UINT64 QueueEnteredTime)
+	{
+		while (!mDisplayed.empty() && mDisplayed.front().DisplayTime <= QueueEnteredTime) {
+			mLastGoneID = mDisplayed.front().PresentID;
+			mDisplayed.pop_front();
+		}
+		return PresentID - mLastGoneID;
+	}
+
+	template<class Emit>
+	void EmitPending(Emit& emit)
+	{
+		for (auto& Record : mPending)
+		{
+			++mTotals.Presents;
+			++(Record.Dropped ? mTotals.Dropped : mTotals.Displayed);
+			mTotals.MissedRefreshes += Record.MissedRefreshes;
+			mTotals.QueueDepthSum += Record.QueueDepth;
+			mTotals.MaxQueueDepth = Record.QueueDepth > mTotals.MaxQueueDepth ? Record.QueueDepth : mTotals.MaxQueueDepth;
+			emit(Record);
+		}
+		mPending.clear();
+	}
+
+	bool mStarted;
+	bool mShown; // mLastShown is the first of mPending
+	bool mHasDisplayTime; // mLastDisplayTime is set
+	UINT mFirstSyncRefreshCount;
+	UINT64 mFirstSyncTime; // 0 until a frame was shown
+	double mRefreshPeriod; // in QPC ticks, 0 until measured
+	UINT64 mStartTime;
+	UINT64 mLastPresentCallTime;
+	ShownPresent mLastShown;
+	UINT64 mLastDisplayTime; // of the frame shown before mLastShown
+	UINT mLastGoneID; // the last present known to have left the queue
+	std::deque<DisplayedPresent> mDisplayed; // shown after mLastGoneID left, in order
+	std::deque<FramePacingRecord> mPending; // the last frame shown, then the ones dropped since
+	Totals mTotals;
+};
+
+// The process columns of a PresentMon CSV; PresentMode is one of PresentMon's
+// names for it, e.g. "Hardware: Independent Flip" or "Composed: Flip".
+struct PresentMonCsvInfo
+{
+	const char *Application;
+	UINT ProcessID;
+	UINT64 SwapChainAddress;
+	const char *PresentMode;
+};
+
+// Writes the columns of PresentMon 1.x, so tools made for its CSV files read
+// these, then the ones it does not have. MsUntilRenderComplete is not
+// tracked and always 0.
+inline void WritePresentMonCsvHeader(FILE *File)
+{
+	fprintf(File, "Application,ProcessID,SwapChainAddress,Runtime,SyncInterval,PresentFlags,AllowsTearing,PresentMode,"
+		"Dropped,TimeInSeconds,MsBetweenPresents,MsBetweenDisplayChange,MsInPresentAPI,MsUntilRenderComplete,MsUntilDisplayed,"
+		"MsDisplayed,RefreshesDisplayed,MissedRefreshes,QueueDepth\n");
+}
+
+inline void WritePresentMonCsvRow(FILE *File, const PresentMonCsvInfo& Info, const FramePacingRecord& Record)
+{
+	fprintf(File, "%s,%u,0x%016llX,DXGI,%u,0,0,%s,%d,%.6f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%u,%u,%u\n",
+		Info.Application, Info.ProcessID, (unsigned long long)Info.SwapChainAddress,
+		Record.SyncInterval, Info.PresentMode, Record.Dropped ? 1 : 0, Record.TimeInSeconds,
+		Record.MsBetweenPresents, Record.MsBetweenDisplayChange, Record.MsInPresentAPI, 0.0,
+		Record.MsUntilDisplayed, Record.MsDisplayed, Record.RefreshesDisplayed, Record.MissedRefreshes,
+		Record.QueueDepth);
+}
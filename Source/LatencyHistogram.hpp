@@ -0,0 +1,177 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WindowsHelpers.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+// Counts durations in log-linear buckets (as HDR histograms do): exact below
+// 1024us, then 512 buckets per power of two, so any percentile is within 0.1%
+// of the true value. Recording is O(1) and the memory is fixed (76KB), however
+// long it runs. Histograms of the same kind add up, so runs on different
+// machines can be merged into one distribution and their percentiles read
+// from it; Write and Read move them through a text file.
+struct LatencyHistogram
+{
+	LatencyHistogram()
+		: mCounts(kBucketCount)
+	{
+		Clear();
+	}
+
+	void Clear()
+	{
+		std::fill(mCounts.begin(), mCounts.end(), 0);
+		mTotal = 0;
+		mFirst = kBucketCount;
+		mLast = 0;
+	}
+
+	void Record(double Milliseconds)
+	{
+		double Micros = Milliseconds * 1000 + 0.5;
+		UINT64 Value = Micros <= 0 ? 0 : Micros >= kMaxValue ? kMaxValue : UINT64(Micros);
+		Add(GetBucket(Value), 1);
+	}
+
+	void Merge(const LatencyHistogram& Other)
+	{
+		for (UINT i = Other.mFirst; i <= Other.mLast && i < kBucketCount; ++i) {
+			if (Other.mCounts[i]) {
+				Add(i, Other.mCounts[i]);
+			}
+		}
+	}
+
+	UINT64 GetCount() const
+	{
+		return mTotal;
+	}
+
+	// The duration that Percent percent of the recorded ones do not exceed,
+	// in milliseconds; 0 if none were recorded.
+	double GetPercentile(double Percent) const
+	{
+		double Percents[] = { Percent };
+		double Result;
+		GetPercentiles(Percents, 1, &Result);
+		return Result;
+	}
+
+	// Several at once, in one pass; Percents must be increasing.
+	void GetPercentiles(const double *Percents, UINT Count, double *Results) const
+	{
+		UINT64 Seen = 0;
+		UINT Bucket = mFirst;
+		for (UINT i = 0; i < Count; ++i)
+		{
+			if (!mTotal) {
+				Results[i] = 0;
+				continue;
+			}
+			UINT64 Rank = UINT64(Percents[i] / 100 * mTotal + 0.5);
+			Rank = Rank < 1 ? 1 : Rank > mTotal ? mTotal : Rank;
+			for (; Seen + mCounts[Bucket] < Rank; ++Bucket) {
+				Seen += mCounts[Bucket];
+			}
+			Results[i] = GetBucketMidpoint(Bucket) / 1000;
+		}
+	}
+
+	// One line per non-empty bucket: the lowest value it holds, in
+	// microseconds, and its count.
+	void Write(FILE *File) const
+	{
+		fprintf(File, "# LatencyHistogram %u\n", kSubBucketBits);
+		for (UINT i = mFirst; i <= mLast && i < kBucketCount; ++i) {
+			if (mCounts[i]) {
+				fprintf(File, "%llu %llu\n", (unsigned long long)GetBucketStart(i), (unsigned long long)mCounts[i]);
+			}
+		}
+	}
+
+	// Adds what Write wrote to this histogram.
+	bool Read(FILE *File)
+	{
+		unsigned SubBucketBits;
+		if (fscanf(File, " # LatencyHistogram %u", &SubBucketBits) != 1 || SubBucketBits != kSubBucketBits) {
+			return false;
+		}
+		unsigned long long Start, Count;
+		while (fscanf(File, "%llu %llu", &Start, &Count) == 2) {
+			Add(GetBucket(Start < kMaxValue ? Start : kMaxValue), Count);
+		}
+		return true;
+	}
+
+private:
+
+	enum : UINT {
+		kSubBucketBits = 10,
+		kSubBucketCount = 1 << kSubBucketBits,
+		kHalfSubBucketCount = kSubBucketCount / 2,
+		kMaxValueBits = 27, // microseconds: 2 minutes, longer ones count as that
+		kBucketCount = (kMaxValueBits - kSubBucketBits + 2) * kHalfSubBucketCount,
+	};
+
+	static const UINT64 kMaxValue = (1ULL << kMaxValueBits) - 1;
+
+	// Values below kSubBucketCount get a bucket each; above, each power of
+	// two gets kHalfSubBucketCount buckets.
+	static UINT GetBucket(UINT64 Value)
+	{
+		if (Value < kSubBucketCount) {
+			return UINT(Value);
+		}
+		UINT Shift = 0;
+		while ((Value >> Shift) >= kSubBucketCount) {
+			++Shift;
+		}
+		return Shift * kHalfSubBucketCount + UINT(Value >> Shift);
+	}
+
+	static UINT64 GetBucketStart(UINT Bucket)
+	{
+		if (Bucket < kSubBucketCount) {
+			return Bucket;
+		}
+		UINT Shift = Bucket / kHalfSubBucketCount - 1;
+		return UINT64(Bucket - Shift * kHalfSubBucketCount) << Shift;
+	}
+
+	static double GetBucketMidpoint(UINT Bucket)
+	{
+		if (Bucket < kSubBucketCount) {
+			return Bucket;
+		}
+		UINT Shift = Bucket / kHalfSubBucketCount - 1;
+		return GetBucketStart(Bucket) + ((1ULL << Shift) - 1) / 2.0;
+	}
+
+	void Add(UINT Bucket, UINT64 Count)
+	{
+		mCounts[Bucket] += Count;
+		mTotal += Count;
+		mFirst = Bucket < mFirst ? Bucket : mFirst;
+		mLast = Bucket > mLast ? Bucket : mLast;
+	}
+
+	std::vector<UINT64> mCounts;
+	UINT64 mTotal;
+	UINT mFirst, mLast; // the range of non-empty buckets
+};
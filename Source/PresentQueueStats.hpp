@@ -1,217 +1,433 @@
-////////////////////////////////////////////////////////////////////////////////
-// Copyright 2017 Intel Corporation
-//
-// Licensed under the Apache License, Version 2.0 (the "License"); you may not
-// use this file except in compliance with the License.  You may obtain a copy
-// of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
-// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
-// License for the specific language governing permissions and limitations
-// under the License.
-////////////////////////////////////////////////////////////////////////////////
-#pragma once
-
-#define NOMINMAX
-#include <Windows.h>
-#include <dxgi1_4.h>
-#include <vector>
-#include <cassert>
-#include <algorithm>
-#include <deque>
-
-struct PresentQueueStats
-{
-	struct QueueEntry
-	{
-		UINT64 FrameBeginTime;
-		UINT64 QueueEnteredTime;
-		UINT64 PreRenderEstimatedSyncTime;
-		UINT64 PresentTimeEstimatedSyncTime;
-		UINT64 QueueExitedTime;
-		void *UserData;
-		UINT PresentID;
-		BOOL Dropped;
-	};
-
-	PresentQueueStats()
-	{
-		memset(this, 0, sizeof(*this));
-	}
-
-	template<class DequeueEntry>
-	HRESULT RetrieveStats(
-		IDXGISwapChain1 *pSwapChain, 
-		DequeueEntry dequeue)
-	{
-		HRESULT hr;
-
-		DXGI_FRAME_STATISTICS stats = { 0 };
-		while (SUCCEEDED(hr = pSwapChain->GetFrameStatistics(&stats)) &&
-			(stats.PresentCount > LastRetrievedID))
-		{
-			//assert(stats.PresentCount - LastRetrievedID < MAX_QUEUE_LENGTH);
-
-			UpdateEntry(stats);
-
-			for (UINT i = LastRetrievedID + 1; i <= stats.PresentCount; ++i)
-			{
-				UINT EntryIndex = i % MAX_QUEUE_LENGTH;
-				auto& Entry = Entries[EntryIndex];
-				QueueEntry e = Entry;
-
-				if (Entry.PresentID != i) {
-					// We overflowed the queue
-					continue;
-				}
-
-				if (Entry.QueueExitedTime < Entry.QueueEnteredTime) {
-					// Something got very, very confused.
-					// This seems to happen when hitting f12 to force enter the debugger.
-					continue;
-				}
-
-				e.Dropped = Entry.QueueExitedTime == TIME_STILL_IN_QUEUE;
-				dequeue(e);
-			}
-
-			LastRetrievedID = stats.PresentCount;
-		}
-
-		return hr;
-	}
-
-	// Call this function after you call pSwapChain->Present()
-	HRESULT PostPresent(
-		IDXGISwapChain1 *pSwapChain,
-		UINT SyncInterval,
-		UINT64 FrameBeginTime,
-		void *UserData)
-	{
-		HRESULT hr;
-
-		UINT64 QpcTime = QpcNow();
-		UINT PresentID;
-
-		hr = pSwapChain->GetLastPresentCount(&PresentID);
-		if (FAILED(hr)) return hr;
-
-		NewEntry(PresentID, FrameBeginTime, QpcTime, UserData);
-
-		return hr;
-	}
-
-private:
-
-	enum : UINT {
-		MAX_QUEUE_LENGTH = 32,
-		INTERVAL_DURATION_WINDOW_SIZE = 7,
-	};
-
-	enum : UINT64 {
-		TIME_STILL_IN_QUEUE = ~(0ULL),
-	};
-
-	UINT LastNewID;
-	UINT LastUpdatedID;
-	UINT LastRetrievedID;
-	QueueEntry Entries[MAX_QUEUE_LENGTH];
-	UINT DurationHistoryWriteIndex;
-
-	void NewEntry(UINT PresentID,
-		UINT64 FrameBeginTime,
-		UINT64 QpcTime,
-		void *UserData)
-	{
-		UINT EntryIndex = PresentID % MAX_QUEUE_LENGTH;
-
-		auto& Entry = Entries[EntryIndex];
-		Entry.FrameBeginTime = FrameBeginTime;
-		Entry.PresentID = PresentID;
-		Entry.UserData = UserData;
-		Entry.QueueEnteredTime = QpcTime;
-		Entry.QueueExitedTime = TIME_STILL_IN_QUEUE;
-
-		LastNewID = PresentID;
-	}
-
-	void UpdateEntry(DXGI_FRAME_STATISTICS& stats)
-	{
-		UINT PresentID = stats.PresentCount;
-		UINT EntryIndex = PresentID % MAX_QUEUE_LENGTH;
-
-		auto& Entry = Entries[EntryIndex];
-		if (Entry.PresentID == PresentID)
-		{
-			Entry.QueueExitedTime = stats.SyncQPCTime.QuadPart;
-			if (PresentID > 0)
-			{
-				UINT PreviousPresentID = PresentID - 1;
-				UINT PreviousEntryIndex = PreviousPresentID % MAX_QUEUE_LENGTH;
-				auto& PreviousEntry = Entries[PreviousEntryIndex];
-				if (PreviousEntry.PresentID == PreviousPresentID &&
-					PreviousEntry.QueueExitedTime != TIME_STILL_IN_QUEUE)
-				{
-					assert(Entry.QueueExitedTime >= PreviousEntry.QueueExitedTime);
-				}
-			}
-			LastUpdatedID = PresentID;
-		}
-	}
-};
-
-struct LatencyStatistics
-{
-	void Sample(double Latency)
-	{
-		mLatencyHistory.push_back(Latency);
-		if (mLatencyHistory.size() > mMaxHistoryLength) {
-			mLatencyHistory.pop_front();
-		}
-	}
-
-	void SetHistoryLength(UINT Length)
-	{
-		mMaxHistoryLength = Length;
-	}
-
-	// absolute temporal distortion: Max(latency) - Min(latency)
-	double EvaluateMinMaxMetric()
-	{
-		if (mLatencyHistory.empty()) {
-			return 0;
-		}
-
-		auto minmax = std::minmax_element(std::begin(mLatencyHistory), std::end(mLatencyHistory));
-		return (*minmax.second) - (*minmax.first);
-	}
-
-	// std. dev of latency
-	double EvaluateStdDevMetric()
-	{
-		if (mLatencyHistory.empty()) {
-			return 0;
-		}
-
-		auto n = mLatencyHistory.size();
-		double sum = 0;
-		double sq_sum = 0;
-
-		for (double L : mLatencyHistory) {
-			sum += L;
-			sq_sum += L*L;
-		}
-		
-		double mean = sum / n;
-		double variance = sq_sum / n - mean * mean;
-		return sqrt(variance);
-	}
-
-private:
-
-	std::deque<double> mLatencyHistory;
-	UINT mMaxHistoryLength;
-};
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#include <dxgi1_4.h>
+#else
+#include "WindowsHelpers.hpp"
+
+// What a stats source fills in for RetrieveStats, as in DXGI
+union LARGE_INTEGER
+{
+	INT64 QuadPart;
+};
+
+struct DXGI_FRAME_STATISTICS
+{
+	UINT PresentCount;
+	UINT PresentRefreshCount;
+	UINT SyncRefreshCount;
+	LARGE_INTEGER SyncQPCTime;
+	LARGE_INTEGER SyncGPUTime;
+};
+#endif
+#include <vector>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <deque>
+
+// Tracks presents from PostPresent until the frame statistics say they
+// left the queue. Capacity is the number of presents that can be in flight
+// between two RetrieveStats calls; older ones are overwritten and counted
+// as overflowed. Must be a power of two.
+// The swap chain is an IDXGISwapChain1, or any stats source with the same
+// GetFrameStatistics and GetLastPresentCount (see Tools/flip_model_sim.hpp).
+template<UINT Capacity = 32>
+struct PresentQueueStats
+{
+	static_assert(Capacity && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	struct QueueEntry
+	{
+		UINT64 FrameBeginTime;
+		UINT64 PresentCallTime; // when Present() was called; QueueEnteredTime if not given
+		UINT64 QueueEnteredTime;
+		UINT64 PreRenderEstimatedSyncTime;
+		UINT64 PresentTimeEstimatedSyncTime;
+		UINT64 QueueExitedTime; // SyncQPCTime of the frame statistics that showed it
+		UINT64 UserData; // as given to PostPresent, e.g. an EventViz::EventHandle
+		UINT PresentID;
+		UINT SyncInterval;
+		UINT PresentRefreshCount; // the vsync it was shown at; 0 if dropped
+		UINT SyncRefreshCount; // the vsync of QueueExitedTime, PresentRefreshCount or later
+		BOOL Dropped;
+	};
+
+	// Presents whose latency can't be trusted, since construction
+	struct EntryErrorCounts
+	{
+		UINT64 Overflowed; // overwritten by newer presents before they were retrieved; skipped
+		UINT64 Invalid; // QueueExitedTime < QueueEnteredTime; skipped
+		UINT64 OutOfOrder; // left the queue before the present ahead of it; still dequeued
+	};
+
+	PresentQueueStats()
+	{
+		memset(this, 0, sizeof(*this));
+	}
+
+	template<class SwapChain, class DequeueEntry>
+	HRESULT RetrieveStats(
+		SwapChain *pSwapChain, 
+		DequeueEntry dequeue)
+	{
+		HRESULT hr;
+
+		DXGI_FRAME_STATISTICS stats = {};
+		while (SUCCEEDED(hr = pSwapChain->GetFrameStatistics(&stats)) &&
+			(stats.PresentCount > LastRetrievedID))
+		{
+			UpdateEntry(stats);
+
+			for (UINT i = LastRetrievedID + 1; i <= stats.PresentCount; ++i)
+			{
+				UINT EntryIndex = i % Capacity;
+				auto& Entry = Entries[EntryIndex];
+				QueueEntry e = Entry;
+
+				if (Entry.PresentID != i) {
+					// We overflowed the queue
+					++ErrorCounts.Overflowed;
+					continue;
+				}
+
+				if (Entry.QueueExitedTime < Entry.QueueEnteredTime) {
+					// Something got very, very confused.
+					// This seems to happen when hitting f12 to force enter the debugger.
+					++ErrorCounts.Invalid;
+					continue;
+				}
+
+				if (Entry.PresentID == OutOfOrderID) {
+					++ErrorCounts.OutOfOrder;
+				}
+
+				e.Dropped = Entry.QueueExitedTime == TIME_STILL_IN_QUEUE;
+				dequeue(e);
+			}
+
+			LastRetrievedID = stats.PresentCount;
+		}
+
+		return hr;
+	}
+
+	// Call this function after you call pSwapChain->Present()
+	// PresentCallTime, if known, is when that call started.
+	template<class SwapChain>
+	HRESULT PostPresent(
+		SwapChain *pSwapChain,
+		UINT SyncInterval,
+		UINT64 FrameBeginTime,
+		UINT64 UserData,
+		UINT64 QpcTime = QpcNow(),
+		UINT64 PresentCallTime = 0)
+	{
+		HRESULT hr;
+
+		UINT PresentID;
+
+		hr = pSwapChain->GetLastPresentCount(&PresentID);
+		if (FAILED(hr)) return hr;
+
+		NewEntry(PresentID, SyncInterval, FrameBeginTime, PresentCallTime ? PresentCallTime : QpcTime, QpcTime, UserData);
+
+		return hr;
+	}
+
+	const EntryErrorCounts& GetErrorCounts() const
+	{
+		return ErrorCounts;
+	}
+
+private:
+
+	enum : UINT {
+		INTERVAL_DURATION_WINDOW_SIZE = 7,
+	};
+
+	enum : UINT64 {
+		TIME_STILL_IN_QUEUE = ~(0ULL),
+	};
+
+	UINT LastNewID;
+	UINT LastUpdatedID;
+	UINT LastRetrievedID;
+	UINT OutOfOrderID; // the last one UpdateEntry found out of order
+	QueueEntry Entries[Capacity];
+	UINT DurationHistoryWriteIndex;
+	EntryErrorCounts ErrorCounts;
+
+	void NewEntry(UINT PresentID,
+		UINT SyncInterval,
+		UINT64 FrameBeginTime,
+		UINT64 PresentCallTime,
+		UINT64 QpcTime,
+		UINT64 UserData)
+	{
+		UINT EntryIndex = PresentID % Capacity;
+
+		auto& Entry = Entries[EntryIndex];
+		Entry.FrameBeginTime = FrameBeginTime;
+		Entry.PresentCallTime = PresentCallTime;
+		Entry.PresentID = PresentID;
+		Entry.SyncInterval = SyncInterval;
+		Entry.UserData = UserData;
+		Entry.QueueEnteredTime = QpcTime;
+		Entry.QueueExitedTime = TIME_STILL_IN_QUEUE;
+		Entry.PresentRefreshCount = 0;
+		Entry.SyncRefreshCount = 0;
+
+		LastNewID = PresentID;
+	}
+
+	void UpdateEntry(DXGI_FRAME_STATISTICS& stats)
+	{
+		UINT PresentID = stats.PresentCount;
+		UINT EntryIndex = PresentID % Capacity;
+
+		auto& Entry = Entries[EntryIndex];
+		if (Entry.PresentID == PresentID)
+		{
+			Entry.QueueExitedTime = stats.SyncQPCTime.QuadPart;
+			Entry.PresentRefreshCount = stats.PresentRefreshCount;
+			Entry.SyncRefreshCount = stats.SyncRefreshCount;
+			if (PresentID > 0)
+			{
+				UINT PreviousPresentID = PresentID - 1;
+				UINT PreviousEntryIndex = PreviousPresentID % Capacity;
+				auto& PreviousEntry = Entries[PreviousEntryIndex];
+				if (PreviousEntry.PresentID == PreviousPresentID &&
+					PreviousEntry.QueueExitedTime != TIME_STILL_IN_QUEUE &&
+					Entry.QueueExitedTime < PreviousEntry.QueueExitedTime)
+				{
+					OutOfOrderID = PresentID;
+				}
+			}
+			LastUpdatedID = PresentID;
+		}
+	}
+};
+
+// Latency over the last 1, 10 and 60 seconds, all at once, in O(1)
+// amortized time per sample: each window keeps running moments (Welford's,
+// with samples removed as they leave it, and the moments recomputed from the
+// ring every kCapacity removals or once most of M2 has cancelled out, before
+// rounding errors can pile up) and monotonic queues of the samples that can
+// still become its minimum or maximum. The samples are kept in one fixed ring
+// shared by the windows; if it fills up, the oldest samples leave the windows
+// early and are counted in GetEvictedCount().
+struct LatencyStatistics
+{
+	enum Window {
+		k1Second,
+		k10Seconds,
+		k60Seconds,
+		kWindowCount
+	};
+
+	enum : UINT {
+		kCapacity = 16384, // samples, a power of 2; 60 seconds at 273Hz
+	};
+
+	LatencyStatistics()
+		: mSamples(kCapacity), mNext(0), mEvicted(0)
+	{
+		for (auto& W : mWindows) {
+			W.Min.resize(kCapacity);
+			W.Max.resize(kCapacity);
+			W.Tail = 0;
+			W.Count = 0;
+			W.Mean = 0;
+			W.M2 = 0;
+			W.PeakM2 = 0;
+			W.Removed = 0;
+			W.MinHead = W.MinTail = 0;
+			W.MaxHead = W.MaxTail = 0;
+		}
+	}
+
+	// Time is the QPC time of the sample, not decreasing from one to the next
+	void Sample(double Latency, UINT64 Time)
+	{
+		auto& Oldest = mWindows[kWindowCount - 1];
+		if (mNext - Oldest.Tail == kCapacity)
+		{
+			for (auto& W : mWindows) {
+				if (W.Tail == Oldest.Tail) {
+					Remove(W);
+				}
+			}
+			++mEvicted;
+		}
+
+		UINT64 Index = mNext++;
+		mSamples[Index & (kCapacity - 1)] = { Time, Latency };
+
+		static const UINT kWindowSeconds[kWindowCount] = { 1, 10, 60 };
+		for (int i = 0; i < kWindowCount; ++i)
+		{
+			auto& W = mWindows[i];
+			Add(W, Index, Latency);
+
+			UINT64 Duration = SecondsToQpcTime(kWindowSeconds[i]);
+			while (Time - GetSample(W.Tail).Time >= Duration) {
+				Remove(W);
+			}
+		}
+	}
+
+	// absolute temporal distortion: Max(latency) - Min(latency)
+	double EvaluateMinMaxMetric(Window Which = k10Seconds) const
+	{
+		auto& W = mWindows[Which];
+		if (!W.Count) {
+			return 0;
+		}
+		double Min = GetSample(W.Min[W.MinHead & (kCapacity - 1)]).Latency;
+		double Max = GetSample(W.Max[W.MaxHead & (kCapacity - 1)]).Latency;
+		return Max - Min;
+	}
+
+	// std. dev of latency
+	double EvaluateStdDevMetric(Window Which = k10Seconds) const
+	{
+		auto& W = mWindows[Which];
+		if (!W.Count) {
+			return 0;
+		}
+		return sqrt(std::max(W.M2, 0.0) / W.Count);
+	}
+
+	double EvaluateMean(Window Which = k10Seconds) const
+	{
+		return mWindows[Which].Mean;
+	}
+
+	UINT GetSampleCount(Window Which = k10Seconds) const
+	{
+		return mWindows[Which].Count;
+	}
+
+	// samples that left the windows before their time because the ring was full
+	UINT64 GetEvictedCount() const
+	{
+		return mEvicted;
+	}
+
+private:
+
+	struct TimedSample
+	{
+		UINT64 Time;
+		double Latency;
+	};
+
+	struct WindowState
+	{
+		UINT64 Tail; // index of the oldest sample in the window
+		UINT Count;
+		double Mean;
+		double M2; // sum of squared differences from the mean
+		double PeakM2; // the largest M2 since then
+		UINT Removed; // samples removed since Mean and M2 were recomputed
+
+		// Indices of the samples that are smaller (larger) than every later
+		// one, oldest first; the first is the minimum (maximum).
+		std::vector<UINT64> Min, Max;
+		UINT64 MinHead, MinTail;
+		UINT64 MaxHead, MaxTail;
+	};
+
+	const TimedSample& GetSample(UINT64 Index) const
+	{
+		return mSamples[Index & (kCapacity - 1)];
+	}
+
+	void Add(WindowState& W, UINT64 Index, double Latency)
+	{
+		++W.Count;
+		double Delta = Latency - W.Mean;
+		W.Mean += Delta / W.Count;
+		W.M2 += Delta * (Latency - W.Mean);
+		W.PeakM2 = std::max(W.PeakM2, W.M2);
+
+		while (W.MinTail != W.MinHead && GetSample(W.Min[(W.MinTail - 1) & (kCapacity - 1)]).Latency >= Latency) {
+			--W.MinTail;
+		}
+		W.Min[W.MinTail++ & (kCapacity - 1)] = Index;
+
+		while (W.MaxTail != W.MaxHead && GetSample(W.Max[(W.MaxTail - 1) & (kCapacity - 1)]).Latency <= Latency) {
+			--W.MaxTail;
+		}
+		W.Max[W.MaxTail++ & (kCapacity - 1)] = Index;
+	}
+
+	// Takes the oldest sample out of the window
+	void Remove(WindowState& W)
+	{
+		UINT64 Index = W.Tail++;
+		double Latency = GetSample(Index).Latency;
+
+		if (--W.Count == 0) {
+			W.Mean = 0;
+			W.M2 = 0;
+		} else {
+			double Delta = Latency - W.Mean;
+			W.Mean -= Delta / W.Count;
+			W.M2 -= Delta * (Latency - W.Mean);
+		}
+		// The rounding errors grow with the removals, and with PeakM2: once
+		// most of it has cancelled out, what is left is mostly error.
+		if (++W.Removed == kCapacity || W.M2 < W.PeakM2 * 1e-6) {
+			Recompute(W);
+		}
+
+		if (W.Min[W.MinHead & (kCapacity - 1)] == Index) {
+			++W.MinHead;
+		}
+		if (W.Max[W.MaxHead & (kCapacity - 1)] == Index) {
+			++W.MaxHead;
+		}
+	}
+
+	// Mean and M2 of the samples in the window, exactly, in two passes
+	void Recompute(WindowState& W)
+	{
+		W.Removed = 0;
+		double Sum = 0;
+		for (UINT64 Index = W.Tail; Index != W.Tail + W.Count; ++Index) {
+			Sum += GetSample(Index).Latency;
+		}
+		W.Mean = W.Count ? Sum / W.Count : 0;
+		W.M2 = 0;
+		for (UINT64 Index = W.Tail; Index != W.Tail + W.Count; ++Index) {
+			double Delta = GetSample(Index).Latency - W.Mean;
+			W.M2 += Delta * Delta;
+		}
+		W.PeakM2 = W.M2;
+	}
+
+	std::vector<TimedSample> mSamples; // ring, indexed by sample number
+	UINT64 mNext; // number of the next sample
+	UINT64 mEvicted;
+	WindowState mWindows[kWindowCount];
+};
@@ -0,0 +1,441 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#include "eviz_trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace EventViz;
+
+// Perfetto's trace is a sequence of TracePacket messages, each one field 1
+// of the Trace message; they are encoded here by hand, with the field
+// numbers of protos/perfetto/trace/trace_packet.proto and the track_event
+// protos. The JSON is a bare array of events, which viewers load without
+// its closing bracket too.
+namespace {
+
+enum : UINT {
+	WIRE_VARINT = 0,
+	WIRE_FIXED64 = 1,
+	WIRE_BYTES = 2,
+};
+
+enum : UINT {
+	TRACE_PACKET = 1,
+
+	PACKET_TIMESTAMP = 8,
+	PACKET_TRUSTED_SEQUENCE_ID = 10,
+	PACKET_TRACK_EVENT = 11,
+	PACKET_SEQUENCE_FLAGS = 13,
+	PACKET_TRACK_DESCRIPTOR = 60,
+
+	SEQ_INCREMENTAL_STATE_CLEARED = 1,
+	SEQ_NEEDS_INCREMENTAL_STATE = 2,
+
+	TRACK_UUID = 1,
+	TRACK_NAME = 2,
+	TRACK_PROCESS = 3,
+	TRACK_PARENT_UUID = 5,
+	PROCESS_PID = 1,
+	PROCESS_NAME = 6,
+
+	EVENT_TYPE = 9,
+	EVENT_TRACK_UUID = 11,
+	EVENT_CATEGORIES = 22,
+	EVENT_NAME = 23,
+	EVENT_FLOW_IDS = 47,
+
+	TYPE_SLICE_BEGIN = 1,
+	TYPE_SLICE_END = 2,
+	TYPE_INSTANT = 3,
+};
+
+static const UINT trace_pid = 1;
+static const UINT trace_sequence_id = 1;
+static const UINT64 process_uuid = 1ULL << 32; // the lanes are numbered from 1
+
+void put_varint(std::string& out, UINT64 value)
+{
+	while (value >= 0x80) {
+		out += char(value | 0x80);
+		value >>= 7;
+	}
+	out += char(value);
+}
+
+void put_tag(std::string& out, UINT field, UINT wire_type)
+{
+	put_varint(out, (UINT64(field) << 3) | wire_type);
+}
+
+void put_uint(std::string& out, UINT field, UINT64 value)
+{
+	put_tag(out, field, WIRE_VARINT);
+	put_varint(out, value);
+}
+
+void put_fixed64(std::string& out, UINT field, UINT64 value)
+{
+	put_tag(out, field, WIRE_FIXED64);
+	for (int i = 0; i < 8; ++i) {
+		out += char(value >> (8 * i));
+	}
+}
+
+void put_bytes(std::string& out, UINT field, const char *data, size_t size)
+{
+	put_tag(out, field, WIRE_BYTES);
+	put_varint(out, size);
+	out.append(data, size);
+}
+
+void put_string(std::string& out, UINT field, const char *text)
+{
+	put_bytes(out, field, text, strlen(text));
+}
+
+void put_message(std::string& out, UINT field, const std::string& message)
+{
+	put_bytes(out, field, message.data(), message.size());
+}
+
+UINT64 to_ns(UINT64 time)
+{
+	return time / g_QpcFreq * 1000000000 + time % g_QpcFreq * 1000000000 / g_QpcFreq;
+}
+
+double to_us(UINT64 time)
+{
+	return double(time) * 1000000 / g_QpcFreq;
+}
+
+// JSON string contents
+void put_json(FILE *file, const char *text)
+{
+	for (; *text; ++text) {
+		unsigned char c = *text;
+		if (c == '"' || c == '\\') {
+			fprintf(file, "\\%c", c);
+		} else if (c < 0x20) {
+			fprintf(file, "\\u%04x", c);
+		} else {
+			fputc(c, file);
+		}
+	}
+}
+
+const char *get_event_name(const EventData& event, const char *queue_name)
+{
+	auto *aux = (const eventviz_aux*)event.UserData;
+	return aux && aux->name ? aux->name : queue_name;
+}
+
+}
+
+eviz_trace_writer::eviz_trace_writer()
+{
+}
+
+eviz_trace_writer::~eviz_trace_writer()
+{
+	close();
+}
+
+bool eviz_trace_writer::open(const char *path, eviz_trace_format format)
+{
+	close();
+
+#ifdef _WIN32
+	if (fopen_s(&file, path, "wb") != 0) {
+		file = nullptr;
+	}
+#else
+	file = fopen(path, "wb");
+#endif
+	if (!file) {
+		return false;
+	}
+	this->format = format;
+
+	if (format == EVIZ_TRACE_CHROME_JSON)
+	{
+		fprintf(file, "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"EventViz\"}}", trace_pid);
+	}
+	else
+	{
+		std::string process;
+		put_uint(process, PROCESS_PID, trace_pid);
+		put_string(process, PROCESS_NAME, "EventViz");
+		std::string track;
+		put_uint(track, TRACK_UUID, process_uuid);
+		put_message(track, TRACK_PROCESS, process);
+		packet.clear();
+		put_uint(packet, PACKET_TRUSTED_SEQUENCE_ID, trace_sequence_id);
+		put_uint(packet, PACKET_SEQUENCE_FLAGS, SEQ_INCREMENTAL_STATE_CLEARED);
+		put_message(packet, PACKET_TRACK_DESCRIPTOR, track);
+		write_packet(packet);
+	}
+
+	quit = false;
+	thread = std::thread(&eviz_trace_writer::run, this);
+	return true;
+}
+
+void eviz_trace_writer::close()
+{
+	if (!file) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		quit = true;
+	}
+	wake.notify_one();
+	thread.join();
+
+	if (format == EVIZ_TRACE_CHROME_JSON) {
+		fprintf(file, "\n]\n");
+	}
+	fclose(file);
+	file = nullptr;
+
+	pending.clear();
+	queue_names.clear();
+	sink.Detach();
+	sink.Records.clear();
+	queue_count = 0;
+	names.clear();
+	lanes.clear();
+	next_tid = 1;
+}
+
+void eviz_trace_writer::collect(EventStream& stream)
+{
+	if (!file) {
+		return;
+	}
+
+	// A new stream is copied whole, and followed from then on
+	if (sink.GetStream() != &stream) {
+		sink.Attach(stream);
+		sink.Records.clear();
+		stream.GetAllEvents(sink.Records);
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+
+		// The writer holds the lock only to take pending, by swapping: if it
+		// has taken everything, the sink's records are swapped in the same
+		// way; if not, they are added, unless that makes too many.
+		if (pending.empty()) {
+			std::swap(pending, sink.Records);
+		} else if (pending.size() + sink.Records.size() <= max_pending) {
+			pending.insert(pending.end(), sink.Records.begin(), sink.Records.end());
+		} else {
+			// events only, as written counts them, not the stream's trim records
+			UINT count = stream.GetQueueCount();
+			lost += std::count_if(sink.Records.begin(), sink.Records.end(),
+				[count](const EventData& event) { return event.Queue < count; });
+		}
+		sink.Records.clear();
+
+		if (stream.GetQueueCount() != queue_count) {
+			queue_count = stream.GetQueueCount();
+			queue_names.resize(queue_count);
+			for (QueueID queue = 0; queue < queue_count; ++queue) {
+				queue_names[queue] = stream.GetQueueName(queue);
+			}
+		}
+	}
+	wake.notify_one();
+}
+
+UINT64 eviz_trace_writer::get_written_count()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return written;
+}
+
+UINT64 eviz_trace_writer::get_lost_count()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return lost;
+}
+
+void eviz_trace_writer::run()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	for (;;)
+	{
+		wake.wait(guard, [this] { return quit || !pending.empty(); });
+		bool stop = quit;
+		std::swap(writing, pending);
+		if (names.size() != queue_names.size()) {
+			names = queue_names;
+		}
+		guard.unlock();
+
+		UINT64 count = 0;
+		for (auto& event : writing) {
+			if (event.Queue < names.size()) {
+				write(event);
+				++count;
+			}
+		}
+		writing.clear();
+		fflush(file);
+
+		guard.lock();
+		written += count;
+		if (stop && pending.empty()) {
+			return;
+		}
+	}
+}
+
+void eviz_trace_writer::write(const EventData& event)
+{
+	const char *queue_name = names[event.Queue].c_str();
+	const char *name = get_event_name(event, queue_name);
+	bool dropped = event.End == UINT64_MAX;
+	bool instant = dropped || event.End <= event.Start;
+	UINT tid = get_lane(event.Queue, event.Start, instant ? event.Start : event.End);
+
+	if (format == EVIZ_TRACE_CHROME_JSON)
+	{
+		fprintf(file, ",\n{\"name\":\"");
+		put_json(file, dropped ? "dropped" : name);
+		fprintf(file, "\",\"cat\":\"");
+		put_json(file, queue_name);
+		if (instant) {
+			fprintf(file, "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%u,\"tid\":%u", to_us(event.Start), trace_pid, tid);
+		} else {
+			fprintf(file, "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%u",
+				to_us(event.Start), to_us(event.End - event.Start), trace_pid, tid);
+		}
+		if (event.UserID && !instant) {
+			// every event of a UserID continues its flow, in the order they start
+			fprintf(file, ",\"bind_id\":\"0x%llx\",\"flow_in\":true,\"flow_out\":true", (unsigned long long)event.UserID);
+		}
+		fprintf(file, ",\"args\":{\"user_id\":%llu", (unsigned long long)event.UserID);
+		if (dropped) {
+			fprintf(file, ",\"type\":\"");
+			put_json(file, name);
+			fprintf(file, "\"");
+		}
+		fprintf(file, "}}");
+		return;
+	}
+
+	std::string track_event;
+	put_uint(track_event, EVENT_TYPE, instant ? TYPE_INSTANT : TYPE_SLICE_BEGIN);
+	put_uint(track_event, EVENT_TRACK_UUID, tid);
+	put_string(track_event, EVENT_CATEGORIES, queue_name);
+	put_string(track_event, EVENT_NAME, dropped ? "dropped" : name);
+	if (event.UserID && !instant) {
+		put_fixed64(track_event, EVENT_FLOW_IDS, event.UserID);
+	}
+	packet.clear();
+	put_uint(packet, PACKET_TIMESTAMP, to_ns(event.Start));
+	put_uint(packet, PACKET_TRUSTED_SEQUENCE_ID, trace_sequence_id);
+	put_uint(packet, PACKET_SEQUENCE_FLAGS, SEQ_NEEDS_INCREMENTAL_STATE);
+	put_message(packet, PACKET_TRACK_EVENT, track_event);
+	write_packet(packet);
+
+	if (!instant)
+	{
+		track_event.clear();
+		put_uint(track_event, EVENT_TYPE, TYPE_SLICE_END);
+		put_uint(track_event, EVENT_TRACK_UUID, tid);
+		packet.clear();
+		put_uint(packet, PACKET_TIMESTAMP, to_ns(event.End));
+		put_uint(packet, PACKET_TRUSTED_SEQUENCE_ID, trace_sequence_id);
+		put_uint(packet, PACKET_SEQUENCE_FLAGS, SEQ_NEEDS_INCREMENTAL_STATE);
+		put_message(packet, PACKET_TRACK_EVENT, track_event);
+		write_packet(packet);
+	}
+}
+
+// Slices on a thread or track have to nest, and events of a queue can
+// overlap (presents wait in the queue together): each queue gets as many
+// lanes as it takes. Instants go on the first one.
+UINT eviz_trace_writer::get_lane(QueueID queue, UINT64 start, UINT64 end)
+{
+	if (lanes.size() <= queue) {
+		lanes.resize(queue + 1);
+	}
+	auto& queue_lanes = lanes[queue];
+
+	lane *found = nullptr;
+	for (auto& l : queue_lanes) {
+		if (l.end <= start || start == end) {
+			found = &l;
+			break;
+		}
+	}
+	if (!found)
+	{
+		if (queue_lanes.size() < max_lanes_per_queue) {
+			queue_lanes.push_back(lane{ next_tid++, 0 });
+			write_track(queue_lanes.back().tid, queue, queue_lanes.size() - 1);
+			found = &queue_lanes.back();
+		} else {
+			// give up on nesting rather than grow without bounds
+			found = &queue_lanes.back();
+		}
+	}
+	found->end = std::max(found->end, end);
+	return found->tid;
+}
+
+void eviz_trace_writer::write_track(UINT tid, QueueID queue, size_t index)
+{
+	char name[256];
+	if (index) {
+		snprintf(name, sizeof(name), "%s %zu", names[queue].c_str(), index + 1);
+	} else {
+		snprintf(name, sizeof(name), "%s", names[queue].c_str());
+	}
+
+	if (format == EVIZ_TRACE_CHROME_JSON)
+	{
+		fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"", trace_pid, tid);
+		put_json(file, name);
+		fprintf(file, "\"}},\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"sort_index\":%u}}",
+			trace_pid, tid, tid);
+		return;
+	}
+
+	std::string track;
+	put_uint(track, TRACK_UUID, tid);
+	put_string(track, TRACK_NAME, name);
+	put_uint(track, TRACK_PARENT_UUID, process_uuid);
+	packet.clear();
+	put_uint(packet, PACKET_TRUSTED_SEQUENCE_ID, trace_sequence_id);
+	put_message(packet, PACKET_TRACK_DESCRIPTOR, track);
+	write_packet(packet);
+}
+
+void eviz_trace_writer::write_packet(const std::string& packet)
+{
+	std::string header;
+	put_tag(header, TRACE_PACKET, WIRE_BYTES);
+	put_varint(header, packet.size());
+	fwrite(header.data(), 1, header.size(), file);
+	fwrite(packet.data(), 1, packet.size(), file);
+}
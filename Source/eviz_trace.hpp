@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "EventViz.hpp"
+#include "eviz_vertices.hpp"
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum eviz_trace_format
+{
+	EVIZ_TRACE_CHROME_JSON, // Trace Event Format, JSON array: chrome://tracing, ui.perfetto.dev
+	EVIZ_TRACE_PERFETTO, // Perfetto TracePacket protobuf: ui.perfetto.dev, trace_processor
+};
+
+// Streams what an EventStream records to a trace file, for capturing more
+// than EventViz shows and reading it in standard trace viewers.
+//
+// collect() runs on the thread that owns the stream and only hands over the
+// commits since the last call, which a CommitSink keeps however many there
+// are; a thread of its own formats and writes them. collect() never waits
+// for that thread: while it is max_pending events behind, what collect()
+// hands over is dropped, whole, and counted in get_lost_count().
+// Every queue becomes a thread (a track in Perfetto), split into as many as
+// it takes for its events not to overlap. Vsyncs are instants, dropped
+// presents instants named after them, and the events that share a UserID
+// (the CPU, GPU and present of one frame) are joined by flow arrows.
+//
+// The file is valid as it grows, so a capture cut short still loads.
+// The UserData of events must be null or an eventviz_aux that outlives
+// the writer, as the app's are.
+struct eviz_trace_writer
+{
+	eviz_trace_writer();
+	~eviz_trace_writer(); // writes what is left and closes the file
+
+	bool open(const char *path, eviz_trace_format format);
+	void close();
+	bool is_open() const { return file != nullptr; }
+
+	// Call on the stream's thread, e.g. once per frame after
+	// EventStream::Flush. A new stream starts with the events it keeps.
+	void collect(EventViz::EventStream& stream);
+
+	UINT64 get_written_count(); // events written so far
+	UINT64 get_lost_count(); // handed over while the writer was too far behind
+
+private:
+	struct lane
+	{
+		UINT tid;
+		UINT64 end; // of its last event
+	};
+
+	void run();
+	void write(const EventViz::EventData& event);
+	void write_track(UINT tid, EventViz::QueueID queue, size_t index);
+	UINT get_lane(EventViz::QueueID queue, UINT64 start, UINT64 end);
+	void write_packet(const std::string& packet);
+
+	enum : size_t {
+		max_pending = 1 << 20, // events waiting to be written, beyond which they are lost
+		max_lanes_per_queue = 64,
+	};
+
+	FILE *file = nullptr;
+	eviz_trace_format format = EVIZ_TRACE_CHROME_JSON;
+
+	std::mutex lock;
+	std::condition_variable wake; // the writer waits on it for work
+
+	// Guarded by lock
+	std::vector<EventViz::EventData> pending;
+	std::vector<std::string> queue_names; // by QueueID
+	UINT64 lost = 0, written = 0;
+	bool quit = false;
+
+	// Owning thread only
+	EventViz::CommitSink sink;
+	UINT queue_count = 0; // of the sink's stream, as last sent
+
+	// Writer thread only
+	std::vector<EventViz::EventData> writing;
+	std::vector<std::string> names; // copy of queue_names
+	std::vector<std::vector<lane>> lanes; // by QueueID
+	UINT next_tid = 1;
+	std::string packet; // scratch, for EVIZ_TRACE_PERFETTO
+
+	std::thread thread; // started by open
+};
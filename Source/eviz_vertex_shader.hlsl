@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#include "vertex_shader.hlsl"
+
+// Expands one eviz_instance (see eviz_vertices.hpp) per draw instance into
+// the vertices build_eviz_vertices would have written for it. flags holds
+// the eviz_draw_mode; expand_eviz_instances is the CPU version of this.
+
+static const uint EVIZ_DRAW_FILLS = 0;
+static const uint EVIZ_DRAW_JOINTS = 1;
+static const uint EVIZ_DRAW_OUTLINES = 2;
+static const uint EVIZ_DRAW_LINES = 3;
+
+static const uint DROPPED = 2; // EventViz::Rectangle::Dropped
+
+// x: 0 = left, 1 = right; y: 0 = top, 1 = bottom, 2 = middle
+static const uint fill_x[6] = { 0, 0, 1, 0, 1, 1 };
+static const uint fill_y[6] = { 1, 0, 1, 0, 1, 0 };
+static const uint dropped_fill_x[6] = { 0, 0, 1, 1, 1, 1 };
+static const uint dropped_fill_y[6] = { 1, 0, 2, 2, 2, 2 };
+static const uint outline_x[8] = { 0, 1, 1, 1, 1, 0, 0, 0 };
+static const uint outline_y[8] = { 0, 0, 0, 1, 1, 1, 1, 0 };
+static const uint dropped_outline_x[8] = { 0, 0, 0, 1, 0, 1, 1, 1 };
+static const uint dropped_outline_y[8] = { 0, 1, 0, 2, 1, 2, 2, 2 };
+
+struct eviz_vs_in
+{
+	float4 bounds : bounds; // left, top, right, bottom; x0, y0, x1, y1 for lines
+	uint rgba : rgba;
+	uint rect_flags : rect_flags;
+	uint id : SV_VertexID;
+};
+
+float4 unpack_rgba(uint rgba)
+{
+	return float4(rgba & 0xff, (rgba >> 8) & 0xff, (rgba >> 16) & 0xff, rgba >> 24) / 255.0;
+}
+
+vs_out eviz_vertex_shader(eviz_vs_in input)
+{
+	bool dropped = (input.rect_flags & DROPPED) != 0;
+	float4 ltrb = input.bounds;
+	uint x, y;
+	bool collapsed = false;
+
+	if (flags == EVIZ_DRAW_FILLS)
+	{
+		x = dropped ? dropped_fill_x[input.id] : fill_x[input.id];
+		y = dropped ? dropped_fill_y[input.id] : fill_y[input.id];
+		collapsed = dropped && input.id >= 3;
+	}
+	else if (flags == EVIZ_DRAW_JOINTS)
+	{
+		// a 3x3 square around either end
+		float2 center = input.id < 6 ? ltrb.xy : ltrb.zw;
+		ltrb = float4(center - 1.5, center + 1.5);
+		x = fill_x[input.id % 6];
+		y = fill_y[input.id % 6];
+		collapsed = input.bounds.x == input.bounds.z;
+	}
+	else if (flags == EVIZ_DRAW_OUTLINES)
+	{
+		x = dropped ? dropped_outline_x[input.id] : outline_x[input.id];
+		y = dropped ? dropped_outline_y[input.id] : outline_y[input.id];
+		collapsed = dropped && input.id >= 6;
+	}
+	else
+	{
+		x = input.id;
+		y = input.id;
+	}
+
+	float2 position;
+	position.x = x ? ltrb.z : ltrb.x;
+	position.y = y == 0 ? ltrb.y : y == 1 ? ltrb.w : (ltrb.y + ltrb.w) / 2;
+
+	uint rgba = 0xff000000; // black
+	if (flags == EVIZ_DRAW_FILLS) {
+		rgba = x ? ((((input.rgba >> 3) & 0x001f1f1f) * 7) | 0xff000000) : input.rgba;
+	}
+
+	vs_out output;
+	output.position = mul(projection, float4(position, 0.0, 1.0));
+	output.color = unpack_rgba(rgba);
+
+	// Primitives that are not drawn are moved outside the clip volume
+	if (collapsed) {
+		output.position = float4(2.0, 2.0, 2.0, 1.0);
+	}
+
+	return output;
+}
@@ -0,0 +1,439 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#include "eviz_vertices.hpp"
+
+#if EVIZ_VERTICES_SIMD && (defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__))
+#define EVIZ_VERTICES_SSE2 1
+#include <emmintrin.h>
+#elif EVIZ_VERTICES_SIMD && (defined(_M_ARM) || defined(_M_ARM64) || defined(__ARM_NEON))
+#define EVIZ_VERTICES_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Every vertex is { x, y, 0, rgba }: a point from the geometry in the low
+// half and a constant in the high half, put together in a register and
+// stored whole. Points are pairs of floats; the geometry is loaded four
+// floats at a time (Rectangle and Line both start with them).
+namespace {
+
+static const UINT black = 0xff000000; // black, full alpha
+
+#if EVIZ_VERTICES_SSE2
+
+typedef __m128 point; // x, y in the two low lanes
+typedef __m128 quad;
+typedef __m128 color; // 0, rgba in the two low lanes
+
+inline quad load_quad(const float *p) { return _mm_loadu_ps(p); }
+inline point low(quad q) { return q; }
+inline point high(quad q) { return _mm_movehl_ps(q, q); }
+inline point make_point(float x, float y) { return _mm_setr_ps(x, y, 0, 0); }
+inline point take_x_y(point a, point b) { return _mm_move_ss(b, a); } // { a.x, b.y }
+inline quad add(quad q, float f) { return _mm_add_ps(q, _mm_set1_ps(f)); }
+inline color make_color(UINT rgba) { return _mm_castsi128_ps(_mm_setr_epi32(0, int(rgba), 0, 0)); }
+inline void store(color_vertex *v, point p, color c) { _mm_storeu_ps(&v->x, _mm_movelh_ps(p, c)); }
+
+#elif EVIZ_VERTICES_NEON
+
+typedef float32x2_t point;
+typedef float32x4_t quad;
+typedef float32x2_t color;
+
+inline quad load_quad(const float *p) { return vld1q_f32(p); }
+inline point low(quad q) { return vget_low_f32(q); }
+inline point high(quad q) { return vget_high_f32(q); }
+inline point make_point(float x, float y) { return vset_lane_f32(y, vdup_n_f32(x), 1); }
+inline point take_x_y(point a, point b) { return vset_lane_f32(vget_lane_f32(a, 0), b, 0); }
+inline quad add(quad q, float f) { return vaddq_f32(q, vdupq_n_f32(f)); }
+inline color make_color(UINT rgba) { return vreinterpret_f32_u32(vset_lane_u32(rgba, vdup_n_u32(0), 1)); }
+inline void store(color_vertex *v, point p, color c) { vst1q_f32(&v->x, vcombine_f32(p, c)); }
+
+#else
+
+struct point { float x, y; };
+struct quad { float f[4]; };
+typedef UINT color;
+
+inline quad load_quad(const float *p) { return { p[0], p[1], p[2], p[3] }; }
+inline point low(quad q) { return { q.f[0], q.f[1] }; }
+inline point high(quad q) { return { q.f[2], q.f[3] }; }
+inline point make_point(float x, float y) { return { x, y }; }
+inline point take_x_y(point a, point b) { return { a.x, b.y }; }
+inline quad add(quad q, float f) { return { q.f[0] + f, q.f[1] + f, q.f[2] + f, q.f[3] + f }; }
+inline color make_color(UINT rgba) { return rgba; }
+inline void store(color_vertex *v, point p, color c)
+{
+	color_vertex out;
+	out.x = p.x;
+	out.y = p.y;
+	out.z = 0;
+	out.rgba = c;
+	*v = out;
+}
+
+#endif
+
+// 1 or 2 triangles
+inline int emit_quad(color_vertex *v, const EventViz::Rectangle& r)
+{
+	auto data = (const eventviz_aux *)r.Event->UserData;
+
+	UINT rgba = data ? data->rgba : black;
+	//UINT right_rgba = ((rgba >> 1) & 0x007f7f7f) | 0xff000000; // half brightness
+	UINT right_rgba = (((rgba >> 3) & 0x001f1f1f) * 7) | 0xff000000; // 7/8th brightness
+	color left_color = make_color(rgba);
+	color right_color = make_color(right_rgba);
+
+	quad ltrb = load_quad(&r.Left);
+	point lt = low(ltrb);
+	point rb = high(ltrb);
+	point lb = take_x_y(lt, rb);
+
+	if (r.Flags & EventViz::Rectangle::Dropped)
+	{
+		// lt
+		// |  '.
+		// |     rm
+		// |  .'
+		// lb
+
+		point rm = make_point(r.Right, (r.Top + r.Bottom) / 2);
+		store(v + 0, lb, left_color);
+		store(v + 1, lt, left_color);
+		store(v + 2, rm, right_color);
+		return 1;
+	}
+
+	// 1---3
+	// | \ |
+	// 0---2
+
+	point rt = take_x_y(rb, lt);
+	store(v + 0, lb, left_color);
+	store(v + 1, lt, left_color);
+	store(v + 2, rb, right_color);
+	store(v + 3, lt, left_color);
+	store(v + 4, rb, right_color);
+	store(v + 5, rt, right_color);
+	return 2;
+}
+
+// a small square on each end of a line, 4 triangles
+inline int emit_line_joints(color_vertex *v, const EventViz::Line& line)
+{
+	if (line.X0 == line.X1) {
+		return 0;
+	}
+
+	color c = make_color(black);
+	quad ends = load_quad(&line.X0);
+	quad lt = add(ends, -1.5f); // left, top of both ends
+	quad rb = add(ends, 1.5f); // right, bottom of both ends
+
+	for (int i = 0; i < 2; ++i)
+	{
+		point end_lt = i ? high(lt) : low(lt);
+		point end_rb = i ? high(rb) : low(rb);
+		store(v + 0, take_x_y(end_lt, end_rb), c);
+		store(v + 1, end_lt, c);
+		store(v + 2, end_rb, c);
+		store(v + 3, end_lt, c);
+		store(v + 4, end_rb, c);
+		store(v + 5, take_x_y(end_rb, end_lt), c);
+		v += 6;
+	}
+	return 4;
+}
+
+// 3 or 4 lines
+inline int emit_quad_outline(color_vertex *v, const EventViz::Rectangle& r)
+{
+	color c = make_color(black);
+	quad ltrb = load_quad(&r.Left);
+	point lt = low(ltrb);
+	point rb = high(ltrb);
+	point lb = take_x_y(lt, rb);
+
+	if (r.Flags & EventViz::Rectangle::Dropped)
+	{
+		point rm = make_point(r.Right, (r.Top + r.Bottom) / 2);
+		store(v + 0, lt, c);
+		store(v + 1, lb, c);
+		store(v + 2, lt, c);
+		store(v + 3, rm, c);
+		store(v + 4, lb, c);
+		store(v + 5, rm, c);
+		return 3;
+	}
+
+	point rt = take_x_y(rb, lt);
+	store(v + 0, lt, c);
+	store(v + 1, rt, c);
+	store(v + 2, rt, c);
+	store(v + 3, rb, c);
+	store(v + 4, rb, c);
+	store(v + 5, lb, c);
+	store(v + 6, lb, c);
+	store(v + 7, lt, c);
+	return 4;
+}
+
+inline void emit_line(color_vertex *v, const EventViz::Line& line)
+{
+	color c = make_color(black);
+	quad ends = load_quad(&line.X0);
+	store(v + 0, low(ends), c);
+	store(v + 1, high(ends), c);
+}
+
+}
+
+UINT build_eviz_vertices(const EventViz::EventVisualization& visualization,
+	color_vertex *write, UINT capacity, eviz_vertex_ranges *ranges)
+{
+	UINT vertex_count = 0;
+
+	*ranges = {};
+
+	auto nr = visualization.Rectangles.size();
+	auto rs = visualization.Rectangles.data();
+
+	auto nl = visualization.Lines.size();
+	auto ls = visualization.Lines.data();
+
+	ranges->tri_start = vertex_count;
+
+	// rectangles
+	for (size_t i = 0; i < nr; ++i)
+	{
+		if (vertex_count + 6 >= capacity) {
+			return vertex_count;
+		}
+		int tris = emit_quad(&write[vertex_count], rs[i]);
+		vertex_count += 3 * tris;
+		ranges->tri_count += tris;
+	}
+
+	// line joints
+	for (size_t i = 0; i < nl; ++i)
+	{
+		if (vertex_count + 12 > capacity) {
+			return vertex_count;
+		}
+		int tris = emit_line_joints(&write[vertex_count], ls[i]);
+		vertex_count += 3 * tris;
+		ranges->tri_count += tris;
+	}
+
+	ranges->line_start = vertex_count;
+
+	// rectangle outlines
+	for (size_t i = 0; i < nr; ++i)
+	{
+		if (vertex_count + 8 >= capacity) {
+			return vertex_count;
+		}
+		int lines = emit_quad_outline(&write[vertex_count], rs[i]);
+		vertex_count += 2 * lines;
+		ranges->line_count += lines;
+	}
+
+	// lines
+	for (size_t i = 0; i < nl; ++i)
+	{
+		if (vertex_count + 2 >= capacity) {
+			return vertex_count;
+		}
+		emit_line(&write[vertex_count], ls[i]);
+		vertex_count += 2;
+		ranges->line_count += 1;
+	}
+
+	return vertex_count;
+}
+
+// Instances
+
+const UINT eviz_vertices_per_instance[EVIZ_DRAW_MODE_COUNT] = { 6, 12, 8, 2 };
+
+UINT build_eviz_instances(const EventViz::EventVisualization& visualization,
+	eviz_instance *write, eviz_instance_ranges *ranges)
+{
+	auto nr = visualization.Rectangles.size();
+	auto rs = visualization.Rectangles.data();
+
+	auto nl = visualization.Lines.size();
+	auto ls = visualization.Lines.data();
+
+	ranges->rect_start = 0;
+	ranges->rect_count = UINT(nr);
+	ranges->line_start = UINT(nr);
+	ranges->line_count = UINT(nl);
+
+	// Put each record together first and store it whole: the destination
+	// is write-combined upload memory.
+	for (size_t i = 0; i < nr; ++i)
+	{
+		auto& r = rs[i];
+		auto data = (const eventviz_aux *)r.Event->UserData;
+
+		eviz_instance instance;
+		instance.x0 = r.Left;
+		instance.y0 = r.Top;
+		instance.x1 = r.Right;
+		instance.y1 = r.Bottom;
+		instance.rgba = data ? data->rgba : black;
+		instance.flags = UINT(r.Flags);
+		write[i] = instance;
+	}
+
+	for (size_t i = 0; i < nl; ++i)
+	{
+		auto& line = ls[i];
+
+		eviz_instance instance;
+		instance.x0 = line.X0;
+		instance.y0 = line.Y0;
+		instance.x1 = line.X1;
+		instance.y1 = line.Y1;
+		instance.rgba = black;
+		instance.flags = 0;
+		write[nr + i] = instance;
+	}
+
+	return UINT(nr + nl);
+}
+
+namespace {
+
+// Corner tables, the same as in eviz_vertex_shader.hlsl: x from the left or
+// right edge, y from the top, bottom or middle.
+enum { L, R };
+enum { T, B, M };
+
+static const unsigned char fill_x[6] = { L, L, R, L, R, R };
+static const unsigned char fill_y[6] = { B, T, B, T, B, T };
+static const unsigned char dropped_fill_x[3] = { L, L, R };
+static const unsigned char dropped_fill_y[3] = { B, T, M };
+static const unsigned char outline_x[8] = { L, R, R, R, R, L, L, L };
+static const unsigned char outline_y[8] = { T, T, T, B, B, B, B, T };
+static const unsigned char dropped_outline_x[6] = { L, L, L, R, L, R };
+static const unsigned char dropped_outline_y[6] = { T, B, T, M, B, M };
+
+// One vertex of an instance, as the shader computes it. Returns false for
+// the vertices it collapses.
+bool expand_vertex(const eviz_instance& instance, UINT mode, UINT id, color_vertex *v)
+{
+	bool dropped = (instance.flags & EventViz::Rectangle::Dropped) != 0;
+	float left = instance.x0, top = instance.y0;
+	float right = instance.x1, bottom = instance.y1;
+	int x, y;
+
+	switch (mode)
+	{
+	case EVIZ_DRAW_FILLS:
+		if (dropped && id >= 3) {
+			return false;
+		}
+		x = dropped ? dropped_fill_x[id] : fill_x[id];
+		y = dropped ? dropped_fill_y[id] : fill_y[id];
+		break;
+
+	case EVIZ_DRAW_JOINTS:
+	{
+		if (instance.x0 == instance.x1) {
+			return false;
+		}
+		// a 3x3 square around either end
+		float cx = id < 6 ? instance.x0 : instance.x1;
+		float cy = id < 6 ? instance.y0 : instance.y1;
+		left = cx - 1.5f;
+		top = cy - 1.5f;
+		right = cx + 1.5f;
+		bottom = cy + 1.5f;
+		x = fill_x[id % 6];
+		y = fill_y[id % 6];
+		break;
+	}
+
+	case EVIZ_DRAW_OUTLINES:
+		if (dropped && id >= 6) {
+			return false;
+		}
+		x = dropped ? dropped_outline_x[id] : outline_x[id];
+		y = dropped ? dropped_outline_y[id] : outline_y[id];
+		break;
+
+	default: // EVIZ_DRAW_LINES
+		x = id ? R : L;
+		y = id ? B : T;
+		break;
+	}
+
+	UINT rgba = black;
+	if (mode == EVIZ_DRAW_FILLS) {
+		rgba = x == R ? (((instance.rgba >> 3) & 0x001f1f1f) * 7) | 0xff000000 : instance.rgba;
+	}
+
+	color_vertex out;
+	out.x = x == L ? left : right;
+	out.y = y == T ? top : y == B ? bottom : (top + bottom) / 2;
+	out.z = 0;
+	out.rgba = rgba;
+	*v = out;
+	return true;
+}
+
+}
+
+UINT expand_eviz_instances(const eviz_instance *instances, const eviz_instance_ranges& ranges,
+	color_vertex *write, UINT capacity, eviz_vertex_ranges *vertex_ranges)
+{
+	// capacity checks, as build_eviz_vertices makes them
+	static const UINT needed[EVIZ_DRAW_MODE_COUNT] = { 7, 12, 9, 3 };
+
+	UINT vertex_count = 0;
+
+	*vertex_ranges = {};
+
+	for (UINT mode = 0; mode < EVIZ_DRAW_MODE_COUNT; ++mode)
+	{
+		bool lines = mode == EVIZ_DRAW_JOINTS || mode == EVIZ_DRAW_LINES;
+		UINT start = lines ? ranges.line_start : ranges.rect_start;
+		UINT count = lines ? ranges.line_count : ranges.rect_count;
+		UINT per_primitive = mode < EVIZ_DRAW_OUTLINES ? 3 : 2;
+		UINT& primitives = mode < EVIZ_DRAW_OUTLINES ? vertex_ranges->tri_count : vertex_ranges->line_count;
+
+		if (mode == EVIZ_DRAW_OUTLINES) {
+			vertex_ranges->line_start = vertex_count;
+		}
+
+		for (UINT i = start; i < start + count; ++i)
+		{
+			if (vertex_count + needed[mode] > capacity) {
+				return vertex_count;
+			}
+			UINT written = 0;
+			for (UINT id = 0; id < eviz_vertices_per_instance[mode]; ++id) {
+				written += expand_vertex(instances[i], mode, id, &write[vertex_count + written]);
+			}
+			vertex_count += written;
+			primitives += written / per_primitive;
+		}
+	}
+
+	return vertex_count;
+}
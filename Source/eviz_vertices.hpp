@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "EventViz.hpp"
+#include "sample_cube.hpp"
+
+// Uses SSE2 or NEON where available; define to 0 for the scalar version.
+#ifndef EVIZ_VERTICES_SIMD
+#define EVIZ_VERTICES_SIMD 1
+#endif
+
+// The UserData of every event the sample records
+struct eventviz_aux
+{
+	const char *name;
+	union {
+		struct {
+			unsigned char r, g, b, a;
+		};
+		unsigned int rgba;
+	};
+};
+
+struct eviz_vertex_ranges
+{
+	UINT tri_start, tri_count; // triangle list: rectangles, then line joints
+	UINT line_start, line_count; // line list: rectangle outlines, then lines
+};
+
+// Turns a visualization into vertices, writing each one exactly once, in
+// order and 16 bytes at a time, which suits write-combined upload memory.
+// Stops before the first primitive that does not fit in capacity.
+// Returns the number of vertices written.
+UINT build_eviz_vertices(const EventViz::EventVisualization& visualization,
+	color_vertex *write, UINT capacity, eviz_vertex_ranges *ranges);
+
+// The compact alternative: one record per rectangle or line, expanded into
+// the same primitives by eviz_vertex_shader.hlsl. 24 bytes where
+// build_eviz_vertices writes 224 for a rectangle and 224 for a line.
+struct eviz_instance
+{
+	float x0, y0, x1, y1; // left, top, right, bottom for rectangles
+	UINT rgba; // the left color, the right one is derived from it
+	UINT flags; // EventViz::Rectangle::FlagBits, 0 for lines
+};
+
+struct eviz_instance_ranges
+{
+	UINT rect_start, rect_count;
+	UINT line_start, line_count;
+};
+
+// What the vertex shader makes of each instance; passed in the Flags root
+// constant, one draw per mode, in this order.
+enum eviz_draw_mode
+{
+	EVIZ_DRAW_FILLS, // 6 vertices per rectangle, triangle list
+	EVIZ_DRAW_JOINTS, // 12 vertices per line, triangle list
+	EVIZ_DRAW_OUTLINES, // 8 vertices per rectangle, line list
+	EVIZ_DRAW_LINES, // 2 vertices per line, line list
+	EVIZ_DRAW_MODE_COUNT
+};
+
+extern const UINT eviz_vertices_per_instance[EVIZ_DRAW_MODE_COUNT];
+
+// Room build_eviz_instances needs: there is no limit other than this.
+inline UINT eviz_instance_count(const EventViz::EventVisualization& visualization)
+{
+	return UINT(visualization.Rectangles.size() + visualization.Lines.size());
+}
+
+// Writes the rectangles, then the lines, each instance exactly once.
+// Returns the number of instances written.
+UINT build_eviz_instances(const EventViz::EventVisualization& visualization,
+	eviz_instance *write, eviz_instance_ranges *ranges);
+
+// Reference for the vertex shader: expands instances the way it does, into
+// the vertices build_eviz_vertices writes for the same visualization. The
+// primitives the shader collapses (the missing half of a dropped rectangle,
+// joints of vertical lines) are left out, and capacity is handled the same.
+UINT expand_eviz_instances(const eviz_instance *instances, const eviz_instance_ranges& ranges,
+	color_vertex *write, UINT capacity, eviz_vertex_ranges *vertex_ranges);
@@ -1,133 +1,264 @@
-////////////////////////////////////////////////////////////////////////////////
-// Copyright 2017 Intel Corporation
-//
-// Licensed under the Apache License, Version 2.0 (the "License"); you may not
-// use this file except in compliance with the License.  You may obtain a copy
-// of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
-// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
-// License for the specific language governing permissions and limitations
-// under the License.
-////////////////////////////////////////////////////////////////////////////////
-#pragma once
-
-#include <memory>
-
-// Timeline_multimap:
-// A multimap that represents a timeline of events.
-// The assumption is that events are inserted "roughly" in chronological order, and in batches.
-// Under these conditions, the performance will be much better than a regular multimap.
-// In order to achieve this extra performance, we accept certain tradeoffs:
-// -Improve average case operations at the cost of worst case.
-// -Sacrifice stable iterators (pretty much any operation invalidates).
-// -Sacrifice stable references (values are not allocated on the heap).
-template<
-	typename K, // the time index, should be integral
-	typename V> // typically std::unique_ptr<some struct>
-struct timeline_multimap
-{
-	struct value_type
-	{
-		K first;
-		V second;
-		template<class... Args> value_type(K k, Args&&... args) 
-			: first(k), second(std::forward<Args>(args)...) { }
-		friend bool operator < (const value_type& lhs, const value_type& rhs) {
-			return lhs.first < rhs.first;
-		}
-		friend bool operator < (const value_type& lhs, const K& rhs) {
-			return lhs.first < rhs;
-		}
-		friend bool operator < (const K& lhs, const value_type& rhs) {
-			return lhs < rhs.first;
-		}
-	};
-
-	typedef typename std::vector<value_type>::iterator iterator;
-
-	bool empty()
-	{
-		return vals.empty();
-	}
-
-	size_t size()
-	{
-		return vals.size();
-	}
-
-	void clear()
-	{
-		vals.clear();
-		unsorted_begin = 0;
-	}
-
-	template<class... Args>
-	iterator emplace(K k, Args&&... args)
-	{
-		auto pos = vals.size();
-		vals.emplace_back(k, std::forward<Args>(args)...);
-		return vals.begin() + pos;
-	}
-
-	iterator lower_bound(const K& k)
-	{
-		sort();
-		return std::lower_bound(vals.begin(), vals.end(), k);
-	}
-
-	iterator upper_bound(const K& k)
-	{
-		sort();
-		return std::upper_bound(vals.begin(), vals.end(), k);
-	}
-
-	iterator begin()
-	{
-		sort();
-		return vals.begin();
-	}
-
-	iterator end()
-	{
-		sort();
-		return vals.end();
-	}
-
-	iterator erase(iterator first, iterator last) {
-		assert(size() == unsorted_begin);
-		auto it = vals.erase(first, last);
-		unsorted_begin = size();
-		return it;
-	}
-
-	iterator erase(iterator position) {
-		assert(size() == unsorted_begin);
-		auto it = vals.erase(position);
-		unsorted_begin = size();
-		return it;
-	}
-
-private:
-
-	void sort()
-	{
-		auto N = size();
-		if (unsorted_begin != N)
-		{
-			auto first = &vals[0];
-			auto mid = first + unsorted_begin;
-			auto last = first + N;
-			unsorted_begin = N;
-			std::sort(mid, last);
-			auto merge_start = std::upper_bound(first, mid, *mid);
-			std::inplace_merge(merge_start, mid, last);
-		}
-	}
-
-	std::vector<value_type> vals;
-	size_t unsorted_begin = 0; // == size() when sorted
-};
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+
+// Timeline_multimap:
+// A multimap that represents a timeline of events.
+// The assumption is that events are inserted "roughly" in chronological order, and in batches.
+// Under these conditions, the performance will be much better than a regular multimap.
+// In order to achieve this extra performance, we accept certain tradeoffs:
+// -Improve average case operations at the cost of worst case.
+// -Sacrifice stable iterators (pretty much any operation invalidates).
+// -Sacrifice stable references (values are not allocated on the heap).
+// Erasing from the front only advances a head index; the dead prefix is
+// reclaimed (and its values destroyed) once it outgrows the live range, so
+// trimming old history costs O(1) amortized regardless of its length.
+// Inserts that are in order, or only a few entries out of order, are put in
+// place immediately; anything older waits in an unsorted tail that is sorted
+// and merged on the next lookup.
+// The backing vector keeps its capacity across trims, so a steady load stops
+// reallocating; it is only shrunk once it is mostly empty.
+//
+// Define TIMELINE_MULTIMAP_STATS to 1 to count which path each operation
+// took (see op_stats); this is how to check the claims above against a real
+// insertion pattern, e.g. by dumping get_stats() from the running app.
+#ifndef TIMELINE_MULTIMAP_STATS
+#define TIMELINE_MULTIMAP_STATS 0
+#endif
+
+template<
+	typename K, // the time index, should be integral
+	typename V> // the mapped value, moved in and out as the map grows
+struct timeline_multimap
+{
+	struct value_type
+	{
+		K first;
+		V second;
+		template<class... Args> value_type(K k, Args&&... args) 
+			: first(k), second(std::forward<Args>(args)...) { }
+		friend bool operator < (const value_type& lhs, const value_type& rhs) {
+			return lhs.first < rhs.first;
+		}
+		friend bool operator < (const value_type& lhs, const K& rhs) {
+			return lhs.first < rhs;
+		}
+		friend bool operator < (const K& lhs, const value_type& rhs) {
+			return lhs < rhs.first;
+		}
+	};
+
+	typedef typename std::vector<value_type>::iterator iterator;
+
+	struct op_stats
+	{
+		size_t appends; // inserted in order
+		size_t insertion_sorts; // inserted a few entries back
+		size_t deferred; // left in the unsorted tail
+		size_t merges; // sorts of the unsorted tail
+		size_t merged_entries; // sorted entries moved by those merges
+		size_t front_erases;
+		size_t compactions;
+		size_t compacted_entries;
+		size_t reallocations; // growth or shrink of the backing vector
+	};
+
+	bool empty() const
+	{
+		return size() == 0;
+	}
+
+	size_t size() const
+	{
+		return vals.size() - head;
+	}
+
+#if TIMELINE_MULTIMAP_STATS
+	const op_stats& get_stats() const { return stats; }
+	void reset_stats() { stats = op_stats(); }
+#endif
+
+	void clear()
+	{
+		vals.clear();
+		head = 0;
+		unsorted_begin = 0;
+	}
+
+	void reserve(size_t count)
+	{
+		vals.reserve(head + count);
+	}
+
+	template<class... Args>
+	iterator emplace(K k, Args&&... args)
+	{
+		auto pos = vals.size();
+		bool sorted = unsorted_begin == pos;
+		count_stat(&op_stats::reallocations, vals.size() == vals.capacity());
+		vals.emplace_back(k, std::forward<Args>(args)...);
+
+		auto last = vals.begin() + pos;
+		if (sorted)
+		{
+			auto first = vals.begin() + head;
+			if (last == first || !(k < (last - 1)->first))
+			{
+				// in order: nothing to do
+				count_stat(&op_stats::appends);
+				unsorted_begin = pos + 1;
+				return last;
+			}
+
+			auto window = last - std::min<size_t>(last - first, insertion_sort_limit);
+			if (!(k < window->first))
+			{
+				// a few entries out of order: insertion sort
+				auto it = std::upper_bound(window, last, k);
+				std::rotate(it, last, last + 1);
+				count_stat(&op_stats::insertion_sorts);
+				unsorted_begin = pos + 1;
+				return it;
+			}
+		}
+
+		count_stat(&op_stats::deferred);
+		return last;
+	}
+
+	iterator lower_bound(const K& k)
+	{
+		sort();
+		return std::lower_bound(vals.begin() + head, vals.end(), k);
+	}
+
+	iterator upper_bound(const K& k)
+	{
+		sort();
+		return std::upper_bound(vals.begin() + head, vals.end(), k);
+	}
+
+	iterator begin()
+	{
+		sort();
+		return vals.begin() + head;
+	}
+
+	iterator end()
+	{
+		sort();
+		return vals.end();
+	}
+
+	iterator erase(iterator first, iterator last) {
+		assert(vals.size() == unsorted_begin);
+		if (first == vals.begin() + head) {
+			return erase_front(size_t(last - first));
+		}
+		auto it = vals.erase(first, last);
+		unsorted_begin = vals.size();
+		return it;
+	}
+
+	iterator erase(iterator position) {
+		return erase(position, position + 1);
+	}
+
+private:
+
+	enum : size_t {
+		insertion_sort_limit = 16, // how far back emplace() will move an entry
+		min_shrink_capacity = 4096,
+	};
+
+	iterator erase_front(size_t count)
+	{
+		count_stat(&op_stats::front_erases);
+		head += count;
+		if (head >= size()) {
+			count_stat(&op_stats::compactions);
+			count_stat(&op_stats::compacted_entries, size());
+			// The dead prefix outgrew the live range: move the live range to
+			// the front. This copies at most as many elements as were erased
+			// since the last time, hence O(1) amortized per element.
+			vals.erase(vals.begin(), vals.begin() + head);
+			head = 0;
+			unsorted_begin = vals.size();
+
+			// Only give memory back when most of it is unused, so that a
+			// history hovering around one size does not reallocate.
+			if (vals.capacity() > min_shrink_capacity &&
+				vals.capacity() > 8 * vals.size()) {
+				count_stat(&op_stats::reallocations);
+				vals.shrink_to_fit();
+			}
+		}
+		return vals.begin() + head;
+	}
+
+	void sort()
+	{
+		auto N = vals.size();
+		if (unsorted_begin != N)
+		{
+			auto base = vals.data();
+			auto first = base + head;
+			auto mid = base + unsorted_begin;
+			auto last = base + N;
+			unsorted_begin = N;
+			std::sort(mid, last);
+			auto merge_start = std::upper_bound(first, mid, *mid);
+			count_stat(&op_stats::merges);
+			count_stat(&op_stats::merged_entries, mid - merge_start);
+
+			// Merge through a scratch copy of the sorted entries that the new
+			// ones interleave with. That run is usually short, and unlike
+			// std::inplace_merge this does not allocate a buffer every time.
+			scratch.assign(std::make_move_iterator(merge_start), std::make_move_iterator(mid));
+			auto out = merge_start;
+			auto a = scratch.begin();
+			auto b = mid;
+			while (a != scratch.end() && b != last) {
+				*out++ = (*b < *a) ? std::move(*b++) : std::move(*a++);
+			}
+			while (a != scratch.end()) {
+				*out++ = std::move(*a++);
+			}
+			scratch.clear();
+		}
+	}
+
+#if TIMELINE_MULTIMAP_STATS
+	void count_stat(size_t op_stats::*counter, size_t amount = 1) { stats.*counter += amount; }
+#else
+	void count_stat(size_t op_stats::*, size_t = 1) { }
+#endif
+
+	std::vector<value_type> vals; // live range is [head, vals.size())
+	std::vector<value_type> scratch; // used by sort()
+	size_t head = 0;
+	size_t unsorted_begin = 0; // == vals.size() when sorted
+#if TIMELINE_MULTIMAP_STATS
+	op_stats stats = op_stats();
+#endif
+};
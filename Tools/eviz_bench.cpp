@@ -0,0 +1,1075 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+// eviz_bench: benchmarks of the parts of EventViz that run on the render
+// thread every frame, on synthetic traces (see eviz_synthetic.hpp), each
+// against what it replaced or against a plain baseline.
+//
+// Build from the repository root, on any platform:
+//   g++ -std=c++14 -O2 -ISource Tools/eviz_bench.cpp Source/EventViz.cpp Source/eviz_vertices.cpp -lpthread -o eviz_bench
+//   cl /EHsc /O2 /ISource Tools\eviz_bench.cpp Source\EventViz.cpp Source\eviz_vertices.cpp
+//
+// ./eviz_bench runs every benchmark, ./eviz_bench pool ... only those named.
+// Times are the median of --repeat runs; heap allocations are counted by
+// replacing operator new.
+
+#include "EventViz.hpp"
+#include "eviz_vertices.hpp"
+#include "eviz_synthetic.hpp"
+#define TOOL_COUNT_ALLOCATIONS
+#include "tool_main.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The same vertex code built without SSE2/NEON, to compare the SIMD one with
+#undef EVIZ_VERTICES_SIMD
+#define EVIZ_VERTICES_SIMD 0
+namespace scalar {
+#include "eviz_vertices.cpp"
+}
+
+using namespace EventViz;
+
+// Keeps the compiler from dropping work whose result is not used
+static volatile UINT64 sink;
+
+struct bench_options
+{
+	int repeat = 5;
+	bool quick = false; // smaller sizes, for a smoke test
+};
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double elapsed_ns(bench_clock::time_point start)
+{
+	return std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+}
+
+// The median of opts.repeat runs of f, which returns nanoseconds
+template<class F>
+static double median_ns(const bench_options& opts, F f)
+{
+	std::vector<double> runs;
+	for (int i = 0; i < opts.repeat; ++i) {
+		runs.push_back(f());
+	}
+	std::sort(runs.begin(), runs.end());
+	return runs[runs.size() / 2];
+}
+
+// Commits the records of a trace from next up to and including the next
+// vsync, the way the app records: each event is started and then ended.
+// offset is added to every time, to replay a trace again after itself.
+// Returns where the next frame starts.
+static size_t record_frame(EventStream& stream, const std::vector<EventData>& records, size_t next, UINT64 offset)
+{
+	for (; next < records.size(); ++next)
+	{
+		auto& record = records[next];
+		if (record.Queue == kVsyncQueue) {
+			stream.Vsync(record.Start + offset);
+			return next + 1;
+		}
+		auto event = stream.Start(record.Queue, record.UserData, record.UserID, record.Start + offset);
+		stream.End(event, record.End == UINT64_MAX ? UINT64_MAX : record.End + offset);
+	}
+	return next;
+}
+
+static void register_queues(EventStream& stream, const trace& in)
+{
+	stream.Pause(false);
+	for (auto& name : in.queue_names) {
+		stream.RegisterQueue(name.c_str());
+	}
+}
+
+// How long the trace lasts, to replay it again right after itself
+static UINT64 get_trace_span(const trace& in)
+{
+	UINT64 first = UINT64_MAX, last = 0;
+	for (auto& record : in.records) {
+		first = std::min(first, record.Start);
+		last = std::max(last, record.Start);
+	}
+	return last - first + g_QpcFreq;
+}
+
+// Records the stream holds without growing, pending ones included
+static size_t get_record_capacity(EventStream& stream)
+{
+	size_t capacity = stream.Pending.capacity();
+	for (auto& track : stream.Tracks) {
+#if EVENTVIZ_COLUMNAR_STORE
+		for (auto& columns : track.Events.Classes) {
+			capacity += columns.Start.capacity();
+		}
+#else
+		capacity += track.Events.Pool.GetCapacity();
+#endif
+	}
+	return capacity;
+}
+
+/// ----------------------------------------------------------------------
+///                                 pool
+/// ----------------------------------------------------------------------
+
+// EventStream records into an EventPool: recording at a steady rate, with
+// the history trimmed every frame, should not touch the heap at all.
+static void bench_pool(const bench_options& opts)
+{
+	printf("pool: recording with Start/End and trimming to 256 vsyncs every frame, twice over the same trace\n");
+	printf("  %-12s %10s %12s %18s %18s\n", "events/vsync", "ns/event", "pool records", "allocs/vsync, 1st", "allocs in all 2nd");
+
+	const UINT tiny_counts[] = { 0, 100, 1000, 10000 };
+	for (UINT tiny : tiny_counts)
+	{
+		synthetic_options synthetic;
+		synthetic.frames = std::min(opts.quick ? 300u : 3000u, 3000000 / (tiny + 1));
+		synthetic.tiny_events = tiny;
+		trace in;
+		make_synthetic_trace(synthetic, in);
+		long frames = count_frames(in);
+		UINT64 span = get_trace_span(in);
+
+		// The first pass grows the pool and the timelines; the second,
+		// the same trace again right after it, should be steady.
+		size_t first_pass_allocations = 0, second_pass_allocations = 0;
+		size_t pool_records = 0;
+		double ns = median_ns(opts, [&]() {
+			EventStream stream;
+			register_queues(stream, in);
+			size_t before = get_allocation_count();
+			for (size_t next = 0; next < in.records.size(); ) {
+				next = record_frame(stream, in.records, next, 0);
+				stream.TrimToLastNVsyncs(256);
+			}
+			size_t middle = get_allocation_count();
+			auto start = bench_clock::now();
+			for (size_t next = 0; next < in.records.size(); ) {
+				next = record_frame(stream, in.records, next, span);
+				stream.TrimToLastNVsyncs(256);
+			}
+			double elapsed = elapsed_ns(start);
+			first_pass_allocations = middle - before;
+			second_pass_allocations = get_allocation_count() - middle;
+			pool_records = get_record_capacity(stream);
+			return elapsed / in.records.size();
+		});
+
+		printf("  %-12.0f %10.1f %12zu %18.2f %18zu\n", double(in.records.size()) / frames, ns, pool_records,
+			double(first_pass_allocations) / frames, second_pass_allocations);
+	}
+
+	// What the pool replaced: a heap allocation per record, in the order
+	// the history releases them.
+	const size_t live = opts.quick ? 10000 : 100000;
+	const size_t operations = 10 * live;
+	std::vector<EventData*> ring(live);
+	double pool_ns = median_ns(opts, [&]() {
+		EventPool pool;
+		for (auto& slot : ring) {
+			slot = pool.Allocate();
+		}
+		auto start = bench_clock::now();
+		for (size_t i = 0; i < operations; ++i) {
+			auto& slot = ring[i % live];
+			pool.Free(slot);
+			slot = pool.Allocate();
+			slot->Start = i;
+		}
+		double elapsed = elapsed_ns(start);
+		for (auto slot : ring) {
+			pool.Free(slot);
+		}
+		return elapsed / operations;
+	});
+	std::vector<std::unique_ptr<EventData>> heap_ring(live);
+	double heap_ns = median_ns(opts, [&]() {
+		for (auto& slot : heap_ring) {
+			slot.reset(new EventData());
+		}
+		auto start = bench_clock::now();
+		for (size_t i = 0; i < operations; ++i) {
+			auto& slot = heap_ring[i % live];
+			slot.reset();
+			slot.reset(new EventData());
+			slot->Start = i;
+		}
+		double elapsed = elapsed_ns(start);
+		for (auto& slot : heap_ring) {
+			slot.reset();
+		}
+		return elapsed / operations;
+	});
+	printf("  free+allocate with %zu live records: EventPool %.1f ns, new/delete %.1f ns\n", live, pool_ns, heap_ns);
+}
+
+/// ----------------------------------------------------------------------
+///                                 scan
+/// ----------------------------------------------------------------------
+
+// Inserts, a full scan and window queries on one queue's history, in each
+// store. Both stores are built whichever one EventStream uses.
+template<class Store, class Setup>
+static void bench_store(const bench_options& opts, const char *name, Setup setup, const std::vector<EventData>& events)
+{
+	const int queries = 1000;
+	UINT64 span = events.back().Start - events.front().Start;
+	UINT64 window = span / 1000; // about 1000 events
+
+	EventSet out;
+	double insert_ns = median_ns(opts, [&]() {
+		Store fresh;
+		setup(fresh);
+		auto start = bench_clock::now();
+		for (auto& event : events) {
+			fresh.Insert(event);
+		}
+		out.clear();
+		fresh.Gather(0, 0, out); // the columns sort on the first query, which is part of inserting
+		return elapsed_ns(start);
+	}) / events.size();
+
+	Store store;
+	setup(store);
+	for (auto& event : events) {
+		store.Insert(event);
+	}
+
+	double scan_ns = median_ns(opts, [&]() {
+		auto start = bench_clock::now();
+		out.clear();
+		store.Gather(0, UINT64_MAX, out);
+		UINT64 sum = 0;
+		for (EventData *event : out) {
+			sum += event->End - event->Start;
+		}
+		sink = sum;
+		return elapsed_ns(start);
+	}) / events.size();
+
+	size_t returned = 0;
+	double window_ns = median_ns(opts, [&]() {
+		std::mt19937 rng(7);
+		returned = 0;
+		auto start = bench_clock::now();
+		for (int i = 0; i < queries; ++i) {
+			UINT64 from = events.front().Start + rng() % (span - window);
+			out.clear();
+			store.Gather(from, from + window, out);
+			UINT64 sum = 0;
+			for (EventData *event : out) {
+				sum += event->End - event->Start;
+			}
+			sink = sum;
+			returned += out.size();
+		}
+		return elapsed_ns(start);
+	}) / queries;
+
+	printf("  %-10zu %-10s %12.1f %14.2f %16.0f %12.2f\n", events.size(), name, insert_ns, scan_ns,
+		window_ns, window_ns * queries / std::max<size_t>(returned, 1));
+}
+
+static void bench_scan(const bench_options& opts)
+{
+	printf("scan: the two stores of completed events\n");
+	printf("  %-10s %-10s %12s %14s %16s %12s\n", "events", "store", "insert ns/ev", "full scan ns/ev", "window ns/query", "window ns/ev");
+
+	const size_t sizes[] = { 10000, 100000, 1000000 };
+	for (size_t n : sizes)
+	{
+		if (opts.quick && n > 100000) {
+			break;
+		}
+
+		// A busy CPU queue: back to back, with some nesting
+		std::mt19937 rng(42);
+		std::vector<EventData> events(n);
+		UINT64 t = 1000000;
+		for (auto& event : events) {
+			t += 1 + rng() % 2000;
+			event = { kCpuQueue, nullptr, 0, t, t + 1 + rng() % 3000 };
+		}
+
+		bench_store<EventTimeline>(opts, "timeline", [](EventTimeline&) {}, events);
+		bench_store<EventColumns>(opts, "columns", [](EventColumns& columns) { columns.Queue = kCpuQueue; }, events);
+	}
+}
+
+/// ----------------------------------------------------------------------
+///                                window
+/// ----------------------------------------------------------------------
+
+// Window queries on the CPU queue: the stores search each duration class
+// from as far back as its longest event could reach. Against them, the two
+// ways it was done before: a lower_bound a quarter of a second before the
+// window, which misses longer events, and a binary search on the running
+// maximum of the ends, which one long event pins to the start of history.
+static void bench_window(const bench_options& opts)
+{
+	printf("window: 16-vsync windows on the CPU queue, about 100 events per vsync\n");
+	printf("  %-12s %-12s %14s %10s\n", "history", "search", "ns/query", "missed");
+
+	synthetic_options synthetic;
+	synthetic.frames = opts.quick ? 300 : 3000;
+	synthetic.tiny_events = 100;
+	trace in;
+	make_synthetic_trace(synthetic, in);
+
+	const int queries = 1000;
+	const UINT64 window = 16 * g_QpcFreq / 60;
+	const UINT64 radius = g_QpcFreq / 4;
+
+	for (int with_long = 0; with_long < 2; ++with_long)
+	{
+		std::vector<EventData> events;
+		for (auto& record : in.records) {
+			if (record.Queue == kCpuQueue) {
+				events.push_back(record);
+			}
+		}
+		auto by_start = [](const EventData& a, const EventData& b) { return a.Start < b.Start; };
+		std::stable_sort(events.begin(), events.end(), by_start);
+		UINT64 first = events.front().Start, span = events.back().Start - first - window;
+		if (with_long) {
+			// Something that stays open the whole time, like a loading screen
+			events.insert(events.begin(), { kCpuQueue, nullptr, 0, first, events.back().Start });
+		}
+		const char *history = with_long ? "1 long event" : "short only";
+
+		std::vector<UINT64> query_starts;
+		std::mt19937 rng(11);
+		for (int i = 0; i < queries; ++i) {
+			query_starts.push_back(first + rng() % span);
+		}
+		auto count_expected = [&]() {
+			size_t count = 0;
+			for (UINT64 from : query_starts) {
+				for (auto& event : events) {
+					count += event.Start <= from + window && VisibleEnd(event.Start, event.End) >= from;
+				}
+			}
+			return count;
+		};
+		size_t expected = count_expected();
+
+		// lower_bound(StartTime - radius), then filter
+		size_t found = 0;
+		double radius_ns = median_ns(opts, [&]() {
+			found = 0;
+			auto start = bench_clock::now();
+			for (UINT64 from : query_starts) {
+				EventData key = { kCpuQueue, nullptr, 0, from > radius ? from - radius : 0, 0 };
+				EventData last_key = { kCpuQueue, nullptr, 0, from + window, 0 };
+				auto last = std::upper_bound(events.begin(), events.end(), last_key, by_start);
+				for (auto it = std::lower_bound(events.begin(), events.end(), key, by_start); it != last; ++it) {
+					found += VisibleEnd(it->Start, it->End) >= from;
+				}
+			}
+			return elapsed_ns(start);
+		}) / queries;
+		printf("  %-12s %-12s %14.0f %10zu\n", history, "radius", radius_ns, expected - found);
+
+		// Running maximum of the ends, in start order
+		std::vector<UINT64> max_end(events.size());
+		UINT64 running = 0;
+		for (size_t i = 0; i < events.size(); ++i) {
+			running = std::max(running, VisibleEnd(events[i].Start, events[i].End));
+			max_end[i] = running;
+		}
+		double max_end_ns = median_ns(opts, [&]() {
+			found = 0;
+			auto start = bench_clock::now();
+			for (UINT64 from : query_starts) {
+				EventData last_key = { kCpuQueue, nullptr, 0, from + window, 0 };
+				size_t last = std::upper_bound(events.begin(), events.end(), last_key, by_start) - events.begin();
+				size_t i = std::lower_bound(max_end.begin(), max_end.begin() + last, from) - max_end.begin();
+				for (; i < last; ++i) {
+					found += VisibleEnd(events[i].Start, events[i].End) >= from;
+				}
+			}
+			return elapsed_ns(start);
+		}) / queries;
+		printf("  %-12s %-12s %14.0f %10zu\n", history, "running max", max_end_ns, expected - found);
+
+		auto run_store = [&](const char *name, auto& store) {
+			for (auto& event : events) {
+				store.Insert(event);
+			}
+			EventSet out;
+			double ns = median_ns(opts, [&]() {
+				found = 0;
+				auto start = bench_clock::now();
+				for (UINT64 from : query_starts) {
+					out.clear();
+					store.Gather(from, from + window, out);
+					found += out.size();
+				}
+				return elapsed_ns(start);
+			}) / queries;
+			printf("  %-12s %-12s %14.0f %10zu\n", history, name, ns, expected - found);
+		};
+		EventTimeline timeline;
+		run_store("timeline", timeline);
+		EventColumns columns;
+		columns.Queue = kCpuQueue;
+		run_store("columns", columns);
+	}
+}
+
+/// ----------------------------------------------------------------------
+///                                 trim
+/// ----------------------------------------------------------------------
+
+// Trimming only advances a head index, so it should cost the same however
+// much history is kept; erasing from the front of a vector, which is what
+// trimming used to do, moves all of it. The history can also be bounded by
+// SetHistoryCapacity, which trims as events are committed.
+static void bench_trim(const bench_options& opts)
+{
+	printf("trim: trimming to the last N vsyncs every frame, about 100 events per vsync\n");
+	printf("  %-8s %-10s %14s %16s %18s %18s\n", "vsyncs", "events", "Trim ns/frame", "erase ns/frame",
+		"ns/event, no cap", "ns/event, capped");
+
+	typedef std::pair<UINT64, const EventData*> entry;
+	auto by_start = [](const entry& a, const entry& b) { return a.first < b.first; };
+
+	const UINT kept_counts[] = { 64, 256, 1024, 4096 };
+	const long measured = opts.quick ? 100 : 600;
+	for (UINT kept : kept_counts)
+	{
+		if (opts.quick && kept > 256) {
+			break;
+		}
+
+		synthetic_options synthetic;
+		synthetic.frames = kept + UINT(measured) + 10;
+		synthetic.tiny_events = 100;
+		trace in;
+		make_synthetic_trace(synthetic, in);
+		long frames = count_frames(in);
+
+		double trim_ns = median_ns(opts, [&]() {
+			EventStream stream;
+			register_queues(stream, in);
+			double elapsed = 0;
+			long frame = 0;
+			for (size_t next = 0; next < in.records.size(); ++frame) {
+				next = record_frame(stream, in.records, next, 0);
+				auto start = bench_clock::now();
+				stream.TrimToLastNVsyncs(kept);
+				if (frame >= frames - measured) {
+					elapsed += elapsed_ns(start);
+				}
+			}
+			return elapsed / measured;
+		});
+
+		// What it replaced: a vector per queue, sorted by start time
+		double erase_ns = median_ns(opts, [&]() {
+			std::vector<std::vector<entry>> queues(in.queue_names.size());
+			std::vector<UINT64> vsyncs;
+			double elapsed = 0;
+			long frame = 0;
+			for (auto& record : in.records) {
+				auto& queue = queues[record.Queue];
+				entry e(record.Start, &record);
+				queue.insert(std::upper_bound(queue.begin(), queue.end(), e, by_start), e);
+				if (record.Queue != kVsyncQueue) {
+					continue;
+				}
+				vsyncs.push_back(record.Start);
+				++frame;
+				if (vsyncs.size() <= kept) {
+					continue;
+				}
+				auto start = bench_clock::now();
+				entry trim_to(vsyncs[vsyncs.size() - kept], nullptr);
+				for (auto& q : queues) {
+					q.erase(q.begin(), std::lower_bound(q.begin(), q.end(), trim_to, by_start));
+				}
+				if (frame > frames - measured) {
+					elapsed += elapsed_ns(start);
+				}
+			}
+			return elapsed / measured;
+		});
+
+		// Recording with and without a bound the size of the busiest queue's
+		// share of the window
+		size_t cpu_events = 0;
+		for (auto& record : in.records) {
+			cpu_events += record.Queue == kCpuQueue;
+		}
+		size_t capacity = cpu_events * kept / frames;
+		double record_ns[2];
+		for (int capped = 0; capped < 2; ++capped) {
+			record_ns[capped] = median_ns(opts, [&]() {
+				EventStream stream;
+				register_queues(stream, in);
+				stream.SetHistoryCapacity(capped ? capacity : 0);
+				auto start = bench_clock::now();
+				for (size_t next = 0; next < in.records.size(); ) {
+					next = record_frame(stream, in.records, next, 0);
+				}
+				return elapsed_ns(start);
+			}) / in.records.size();
+		}
+
+		printf("  %-8u %-10zu %14.0f %16.0f %18.1f %18.1f\n", kept, in.records.size() * kept / frames,
+			trim_ns, erase_ns, record_ns[0], record_ns[1]);
+	}
+}
+
+/// ----------------------------------------------------------------------
+///                              contention
+/// ----------------------------------------------------------------------
+
+// Threads recording at full speed while the owning thread flushes, through
+// an EventRecorder each, against what they would do without recorders:
+// take a lock around EventStream::InsertEvent.
+static void bench_contention(const bench_options& opts)
+{
+	printf("contention: threads recording as fast as they can, the owning thread flushing meanwhile\n");
+	printf("  %-8s %18s %10s %18s\n", "threads", "recorder ns/event", "dropped", "locked ns/event");
+
+	const UINT events_per_thread = opts.quick ? 20000 : 200000;
+	const int thread_counts[] = { 1, 2, 4, 8 };
+	for (int thread_count : thread_counts)
+	{
+		UINT64 dropped = 0;
+		double recorder_ns = median_ns(opts, [&]() {
+			EventStream stream;
+			stream.Pause(false);
+			std::vector<QueueID> queues;
+			for (int i = 0; i < thread_count; ++i) {
+				queues.push_back(stream.RegisterQueue(("Thread " + std::to_string(i)).c_str()));
+			}
+			std::atomic<int> running(thread_count);
+			std::atomic<UINT64> lost(0);
+			auto start = bench_clock::now();
+			std::vector<std::thread> threads;
+			for (int i = 0; i < thread_count; ++i) {
+				threads.emplace_back([&, i]() {
+					EventRecorder recorder(stream);
+					for (UINT j = 1; j <= events_per_thread; ++j) {
+						recorder.InsertEvent(queues[i], j, j + 1);
+					}
+					lost += recorder.GetDroppedCount();
+					--running;
+				});
+			}
+			while (running) {
+				stream.Flush();
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			stream.Flush();
+			dropped = lost;
+			return elapsed_ns(start);
+		}) / (double(events_per_thread) * thread_count);
+
+		double locked_ns = median_ns(opts, [&]() {
+			EventStream stream;
+			stream.Pause(false);
+			std::vector<QueueID> queues;
+			for (int i = 0; i < thread_count; ++i) {
+				queues.push_back(stream.RegisterQueue(("Thread " + std::to_string(i)).c_str()));
+			}
+			std::mutex lock;
+			auto start = bench_clock::now();
+			std::vector<std::thread> threads;
+			for (int i = 0; i < thread_count; ++i) {
+				threads.emplace_back([&, i]() {
+					for (UINT j = 1; j <= events_per_thread; ++j) {
+						std::lock_guard<std::mutex> guard(lock);
+						stream.InsertEvent(queues[i], j, j + 1);
+					}
+				});
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			return elapsed_ns(start);
+		}) / (double(events_per_thread) * thread_count);
+
+		printf("  %-8d %18.1f %9.1f%% %18.1f\n", thread_count, recorder_ns,
+			100.0 * dropped / (double(events_per_thread) * thread_count), locked_ns);
+	}
+	// With fewer cores than threads, the flushing thread cannot keep up and
+	// recorders drop what does not fit in their ring.
+	printf("  (%u hardware threads)\n", std::thread::hardware_concurrency());
+}
+
+/// ----------------------------------------------------------------------
+///                                 links
+/// ----------------------------------------------------------------------
+
+// What ConnectTheDots did before it hashed the second range on UserID:
+// compare every pair of rectangles.
+static void connect_pairs(std::vector<Line>& lines, const std::vector<Rectangle>& rectangles,
+	size_t begin1, size_t end1, size_t begin2, size_t end2, bool primary_only)
+{
+	for (size_t i = begin1; i < end1; ++i) {
+		for (size_t j = std::max(i, begin2); j < end2; ++j) {
+			auto& r1 = rectangles[i];
+			auto& r2 = rectangles[j];
+			if (r1.Event->UserID == r2.Event->UserID &&
+				(!primary_only || (r1.Flags & r2.Flags & Rectangle::Primary)) &&
+				(!(r1.Sequence | r2.Sequence) || abs(r1.Sequence - r2.Sequence) == 1))
+			{
+				lines.push_back({ (r1.Left + r1.Right) / 2, (r1.Top + r1.Bottom) / 2,
+					(r2.Left + r2.Right) / 2, (r2.Top + r2.Bottom) / 2 });
+			}
+		}
+	}
+}
+
+// The links CreateVisualization makes, the pairwise way. Rectangles are laid
+// out a queue at a time, and the display row, last, is the present queue
+// rectangles at the top of it.
+static void connect_pairs(const EventVisualization& visualization, std::vector<Line>& lines)
+{
+	auto& rectangles = visualization.Rectangles;
+	auto range = [&](QueueID queue, size_t& begin, size_t& end) {
+		begin = 0;
+		while (begin < rectangles.size() && rectangles[begin].Event->Queue != queue) {
+			++begin;
+		}
+		end = begin;
+		while (end < rectangles.size() && rectangles[end].Event->Queue == queue) {
+			++end;
+		}
+	};
+	size_t cpu_begin, cpu_end, gpu_begin, gpu_end, present_begin, display_end;
+	range(kCpuQueue, cpu_begin, cpu_end);
+	range(kGpuQueue, gpu_begin, gpu_end);
+	range(kPresentQueue, present_begin, display_end);
+	size_t display_begin = display_end;
+	while (display_begin > present_begin && rectangles[display_begin - 1].Top == rectangles[display_end - 1].Top) {
+		--display_begin;
+	}
+
+	lines.clear();
+	connect_pairs(lines, rectangles, cpu_begin, cpu_end, gpu_begin, gpu_end, true);
+	connect_pairs(lines, rectangles, cpu_begin, cpu_end, present_begin, display_begin, true);
+	connect_pairs(lines, rectangles, present_begin, display_begin, present_begin, display_begin, false);
+	connect_pairs(lines, rectangles, present_begin, display_begin, display_begin, display_end, false);
+}
+
+// A frame of CreateVisualization as the window widens, against matching the
+// links of the same rectangles pairwise. Each pass over a range is linear in
+// it now, so the frame should grow with the vsyncs shown, not with their
+// square.
+static void bench_links(const bench_options& opts)
+{
+	printf("links: CreateVisualization scrolling by a vsync per frame, 100 events per vsync\n");
+	printf("  %-8s %12s %10s %16s %20s\n", "vsyncs", "rectangles", "links", "frame ns", "pairwise links ns");
+
+	const UINT shown_counts[] = { 16, 64, 128, 240, 512 };
+	const long measured = opts.quick ? 30 : 200;
+	const FloatRect screen = { 0, 0, 1920, 1080 };
+	for (UINT shown : shown_counts)
+	{
+		if (opts.quick && shown > 128) {
+			break;
+		}
+
+		synthetic_options synthetic;
+		synthetic.frames = shown + UINT(measured) + 10;
+		synthetic.tiny_events = 100;
+		trace in;
+		make_synthetic_trace(synthetic, in);
+		long frames = count_frames(in);
+
+		size_t rectangles = 0, links = 0;
+		double pairwise_ns = 0;
+		bool same_links = true;
+		double frame_ns = median_ns(opts, [&]() {
+			EventStream stream;
+			register_queues(stream, in);
+			EventVisualization visualization;
+			std::vector<Line> lines;
+			double elapsed = 0;
+			pairwise_ns = 0;
+			long frame = 0;
+			for (size_t next = 0; next < in.records.size(); ++frame) {
+				next = record_frame(stream, in.records, next, 0);
+				stream.TrimToLastNVsyncs(shown + 16);
+				UINT vsync_count = stream.GetVsyncCount();
+				if (vsync_count < 2) {
+					continue;
+				}
+				UINT first = vsync_count <= shown ? 0 : vsync_count - shown - 1;
+				auto start = bench_clock::now();
+				CreateVisualization(stream, first, vsync_count - 1, screen, visualization);
+				double frame_elapsed = elapsed_ns(start);
+				if (frame < frames - measured) {
+					continue;
+				}
+				elapsed += frame_elapsed;
+
+				start = bench_clock::now();
+				connect_pairs(visualization, lines);
+				pairwise_ns += elapsed_ns(start);
+
+				// The hashed links, then a line per vsync
+				rectangles = visualization.Rectangles.size();
+				links = visualization.Lines.size() - (vsync_count - 1 - first + 1);
+				same_links &= lines.size() == links;
+			}
+			pairwise_ns /= measured;
+			return elapsed / measured;
+		});
+
+		printf("  %-8u %12zu %10zu %16.0f %20.0f%s\n", shown, rectangles, links, frame_ns, pairwise_ns,
+			same_links ? "" : "  (links differ)");
+	}
+}
+
+/// ----------------------------------------------------------------------
+///                               sequence
+/// ----------------------------------------------------------------------
+
+// Present and display rectangles are numbered per UserID through a
+// SequenceTable, a count per ID in an array indexed from the smallest ID of
+// the window, where a std::map used to be. The deeper the present queue, the
+// more rectangles each present has, and the more lookups a frame makes.
+static void bench_sequence(const bench_options& opts)
+{
+	printf("sequence: numbering the present rectangles of 64 vsyncs, and the whole frame, by present queue depth\n");
+	printf("  %-6s %12s %18s %16s %16s\n", "depth", "rectangles", "SequenceTable ns", "std::map ns", "frame ns");
+
+	const UINT depths[] = { 3, 8, 32, 64 };
+	const UINT shown = 64;
+	const long measured = opts.quick ? 30 : 200;
+	const FloatRect screen = { 0, 0, 1920, 1080 };
+	for (UINT depth : depths)
+	{
+		if (opts.quick && depth > 8) {
+			break;
+		}
+
+		synthetic_options synthetic;
+		synthetic.frames = 2 * (shown + UINT(measured)) + 4 * depth; // until the queue is full
+		synthetic.queue_depth = depth;
+		trace in;
+		make_synthetic_trace(synthetic, in);
+		long frames = count_frames(in);
+
+		// The UserIDs numbered in each measured frame, in layout order
+		std::vector<std::vector<UINT64>> numbered;
+		double frame_ns = median_ns(opts, [&]() {
+			EventStream stream;
+			register_queues(stream, in);
+			EventVisualization visualization;
+			double elapsed = 0;
+			numbered.clear();
+			long frame = 0;
+			for (size_t next = 0; next < in.records.size(); ++frame) {
+				next = record_frame(stream, in.records, next, 0);
+				// Presents wait up to depth vsyncs, and the oldest in the window
+				// must still be there.
+				stream.TrimToLastNVsyncs(shown + depth + 16);
+				UINT vsync_count = stream.GetVsyncCount();
+				if (vsync_count < 2) {
+					continue;
+				}
+				UINT first = vsync_count <= shown ? 0 : vsync_count - shown - 1;
+				auto start = bench_clock::now();
+				CreateVisualization(stream, first, vsync_count - 1, screen, visualization);
+				double frame_elapsed = elapsed_ns(start);
+				if (frame < frames - measured) {
+					continue;
+				}
+				elapsed += frame_elapsed;
+				numbered.emplace_back();
+				for (auto& rectangle : visualization.Rectangles) {
+					if (rectangle.Event->Queue == kPresentQueue) {
+						numbered.back().push_back(rectangle.Event->UserID);
+					}
+				}
+			}
+			return elapsed / measured;
+		});
+
+		size_t rectangles = 0;
+		for (auto& ids : numbered) {
+			rectangles += ids.size();
+		}
+
+		SequenceTable table;
+		double table_ns = median_ns(opts, [&]() {
+			UINT64 sum = 0;
+			auto start = bench_clock::now();
+			for (auto& ids : numbered) {
+				UINT64 min_id = UINT64_MAX, max_id = 0;
+				for (UINT64 id : ids) {
+					min_id = std::min(min_id, id);
+					max_id = std::max(max_id, id);
+				}
+				table.Reset(std::min(min_id, max_id), max_id, ids.size());
+				for (UINT64 id : ids) {
+					sum += ++table[id];
+				}
+			}
+			double elapsed = elapsed_ns(start);
+			sink = sum;
+			return elapsed / measured;
+		});
+
+		std::map<UINT64, int> counter;
+		double map_ns = median_ns(opts, [&]() {
+			UINT64 sum = 0;
+			auto start = bench_clock::now();
+			for (auto& ids : numbered) {
+				counter.clear();
+				for (UINT64 id : ids) {
+					sum += ++counter[id];
+				}
+			}
+			double elapsed = elapsed_ns(start);
+			sink = sum;
+			return elapsed / measured;
+		});
+
+		printf("  %-6u %12zu %18.0f %16.0f %16.0f\n", depth, rectangles / measured, table_ns, map_ns, frame_ns);
+	}
+}
+
+/// ----------------------------------------------------------------------
+///                                  lod
+/// ----------------------------------------------------------------------
+
+// Events narrower than a pixel are merged, so the geometry of a frame is
+// bounded by the width of the screen rather than by the events in the window.
+static void bench_lod(const bench_options& opts)
+{
+	printf("lod: 16 vsyncs on 1920 pixels, by tiny CPU events per frame\n");
+	printf("  %-12s %12s %12s %10s %10s %12s %12s\n", "events/vsync", "in window", "rectangles", "merged",
+		"vertices", "layout ns", "vertices ns");
+
+	const UINT tiny_counts[] = { 0, 100, 1000, 10000 };
+	const UINT shown = 16;
+	const long measured = opts.quick ? 20 : 100;
+	const FloatRect screen = { 0, 0, 1920, 1080 };
+	for (UINT tiny : tiny_counts)
+	{
+		if (opts.quick && tiny > 1000) {
+			break;
+		}
+
+		synthetic_options synthetic;
+		synthetic.frames = shown + UINT(measured) + 10;
+		synthetic.tiny_events = tiny;
+		trace in;
+		make_synthetic_trace(synthetic, in);
+		long frames = count_frames(in);
+
+		size_t rectangles = 0, merged = 0, vertex_count = 0;
+		double vertices_ns = 0;
+		std::vector<color_vertex> vertices;
+		double layout_ns = median_ns(opts, [&]() {
+			EventStream stream;
+			register_queues(stream, in);
+			EventVisualization visualization;
+			double elapsed = 0;
+			vertices_ns = 0;
+			rectangles = merged = vertex_count = 0;
+			long frame = 0;
+			for (size_t next = 0; next < in.records.size(); ++frame) {
+				next = record_frame(stream, in.records, next, 0);
+				stream.TrimToLastNVsyncs(shown + 16);
+				UINT vsync_count = stream.GetVsyncCount();
+				if (vsync_count < 2) {
+					continue;
+				}
+				UINT first = vsync_count <= shown ? 0 : vsync_count - shown - 1;
+				auto start = bench_clock::now();
+				CreateVisualization(stream, first, vsync_count - 1, screen, visualization);
+				double frame_elapsed = elapsed_ns(start);
+				if (frame < frames - measured) {
+					continue;
+				}
+				elapsed += frame_elapsed;
+
+				UINT capacity = UINT(16 * (visualization.Rectangles.size() + visualization.Lines.size()));
+				vertices.resize(capacity);
+				eviz_vertex_ranges ranges;
+				start = bench_clock::now();
+				vertex_count += build_eviz_vertices(visualization, vertices.data(), capacity, &ranges);
+				vertices_ns += elapsed_ns(start);
+				rectangles += visualization.Rectangles.size();
+				merged += visualization.Summaries.size();
+			}
+			vertices_ns /= measured;
+			return elapsed / measured;
+		});
+
+		double events_per_vsync = double(in.records.size()) / frames;
+		printf("  %-12.0f %12.0f %12zu %10zu %10zu %12.0f %12.0f\n", events_per_vsync, events_per_vsync * shown,
+			rectangles / measured, merged / measured, vertex_count / measured, layout_ns, vertices_ns);
+	}
+}
+
+/// ----------------------------------------------------------------------
+///                               vertices
+/// ----------------------------------------------------------------------
+
+// build_eviz_vertices puts every vertex together in a register and stores
+// it whole, with SSE2 or NEON; the scalar build stores it a field at a time.
+static void bench_vertices(const bench_options& opts)
+{
+	printf("vertices: build_eviz_vertices on the last frame of a trace, SIMD and scalar\n");
+	printf("  %-8s %12s %10s %10s %12s %12s %12s\n", "vsyncs", "rectangles", "lines", "vertices",
+		"SIMD ns", "scalar ns", "SIMD Mvert/s");
+
+	const UINT shown_counts[] = { 16, 64, 240 };
+	const FloatRect screen = { 0, 0, 3840, 2160 };
+	for (UINT shown : shown_counts)
+	{
+		synthetic_options synthetic;
+		synthetic.frames = shown + 16;
+		synthetic.tiny_events = 1000;
+		synthetic.user_tracks = 4;
+		trace in;
+		make_synthetic_trace(synthetic, in);
+
+		EventStream stream;
+		register_queues(stream, in);
+		for (size_t next = 0; next < in.records.size(); ) {
+			next = record_frame(stream, in.records, next, 0);
+		}
+		UINT vsync_count = stream.GetVsyncCount();
+		EventVisualization visualization;
+		CreateVisualization(stream, vsync_count - 1 - std::min(shown, vsync_count - 1), vsync_count - 1, screen, visualization);
+
+		UINT capacity = UINT(16 * (visualization.Rectangles.size() + visualization.Lines.size()));
+		std::vector<color_vertex> vertices(capacity);
+		eviz_vertex_ranges ranges;
+		UINT count = 0;
+		const int builds = opts.quick ? 20 : 200;
+		double simd_ns = median_ns(opts, [&]() {
+			auto start = bench_clock::now();
+			for (int i = 0; i < builds; ++i) {
+				count = build_eviz_vertices(visualization, vertices.data(), capacity, &ranges);
+			}
+			return elapsed_ns(start) / builds;
+		});
+		double scalar_ns = median_ns(opts, [&]() {
+			auto start = bench_clock::now();
+			for (int i = 0; i < builds; ++i) {
+				sink = scalar::build_eviz_vertices(visualization, vertices.data(), capacity, &ranges);
+			}
+			return elapsed_ns(start) / builds;
+		});
+
+		printf("  %-8u %12zu %10zu %10u %12.0f %12.0f %12.0f\n", shown, visualization.Rectangles.size(),
+			visualization.Lines.size(), count, simd_ns, scalar_ns, count * 1e3 / simd_ns);
+	}
+}
+
+/// ----------------------------------------------------------------------
+
+struct benchmark
+{
+	const char *name;
+	void (*run)(const bench_options& opts);
+};
+
+static const benchmark benchmarks[] = {
+	{ "pool", bench_pool },
+	{ "scan", bench_scan },
+	{ "window", bench_window },
+	{ "trim", bench_trim },
+	{ "contention", bench_contention },
+	{ "links", bench_links },
+	{ "sequence", bench_sequence },
+	{ "lod", bench_lod },
+	{ "vertices", bench_vertices },
+};
+
+static void usage()
+{
+	printf(
+		"usage: eviz_bench [options] [benchmark...]\n"
+		"Runs the named benchmarks, or all of them.\n"
+		"  --repeat N   runs per measurement, the median is reported (5)\n"
+		"  --quick      smaller sizes, to check that they run\n"
+		"benchmarks:");
+	for (auto& b : benchmarks) {
+		printf(" %s", b.name);
+	}
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+	bench_options opts;
+	std::vector<const benchmark*> selected;
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		if (!strcmp(arg, "--repeat") && i + 1 < argc) {
+			opts.repeat = std::max(1, atoi(argv[++i]));
+			continue;
+		}
+		if (!strcmp(arg, "--quick")) {
+			opts.quick = true;
+			continue;
+		}
+		const benchmark *found = nullptr;
+		for (auto& b : benchmarks) {
+			if (!strcmp(arg, b.name)) {
+				found = &b;
+			}
+		}
+		if (!found) {
+			usage();
+			return 1;
+		}
+		selected.push_back(found);
+	}
+	if (selected.empty()) {
+		for (auto& b : benchmarks) {
+			selected.push_back(&b);
+		}
+	}
+
+	for (auto b : selected) {
+		b->run(opts);
+		printf("\n");
+	}
+	return 0;
+}
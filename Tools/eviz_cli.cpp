@@ -0,0 +1,476 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+// eviz_cli: runs the EventViz layout and the timeline geometry builders
+// without the D3D12 app, on a recorded or synthetic trace, and reports how
+// long each stage takes per frame. The geometry of one frame can be written
+// out as SVG or JSON, to look at or to diff.
+//
+// Build from the repository root, on any platform:
+//   g++ -std=c++14 -O2 -ISource Tools/eviz_cli.cpp Source/EventViz.cpp Source/eviz_vertices.cpp Source/eviz_trace.cpp -lpthread -o eviz_cli
+//   cl /EHsc /O2 /ISource Tools\eviz_cli.cpp Source\EventViz.cpp Source\eviz_vertices.cpp Source\eviz_trace.cpp
+//
+// A trace is a text file with one committed event per line, in the order
+// the events were committed:
+//   queue,start,end,user_id,type
+// queue is Vsync, Present, GPU, CPU or the name of a user-defined track;
+// start and end are QPC ticks, end is "dropped" for dropped presents; type
+// names the event for coloring. Lines starting with # are ignored.
+// Each Vsync ends a frame: the frame is laid out and built like the app does.
+//
+// --chrome-trace and --perfetto export the whole trace through
+// eviz_trace_writer, collecting once per frame as the app would, for
+// chrome://tracing or ui.perfetto.dev.
+
+#include "EventViz.hpp"
+#include "eviz_vertices.hpp"
+#include "eviz_trace.hpp"
+#include "eviz_synthetic.hpp"
+#include "tool_main.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace EventViz;
+
+struct options
+{
+	const char *trace_path = nullptr;
+	const char *write_trace_path = nullptr;
+	const char *svg_path = nullptr;
+	const char *json_path = nullptr;
+	const char *chrome_trace_path = nullptr;
+	const char *perfetto_path = nullptr;
+	synthetic_options synthetic;
+	UINT window = 16; // vsyncs shown
+	UINT history = 256; // vsyncs kept
+	float width = 1024, height = 768;
+	long dump_frame = -1; // last
+	bool worker = false;
+};
+
+static bool read_trace(const char *path, trace& out)
+{
+	FILE *file = fopen(path, "r");
+	if (!file) {
+		fprintf(stderr, "cannot open %s\n", path);
+		return false;
+	}
+
+	char line[1024];
+	int line_number = 0;
+	while (fgets(line, sizeof(line), file))
+	{
+		++line_number;
+		line[strcspn(line, "\r\n")] = 0;
+		if (line[0] == '#' || line[0] == 0) {
+			continue;
+		}
+
+		std::string fields[5];
+		int field = 0;
+		for (const char *c = line; *c && field < 5; ++c) {
+			if (*c == ',') {
+				++field;
+			} else {
+				fields[field] += *c;
+			}
+		}
+
+		UINT64 start = strtoull(fields[1].c_str(), nullptr, 10);
+		UINT64 end = fields[2] == "dropped" ? UINT64_MAX : strtoull(fields[2].c_str(), nullptr, 10);
+		if (field < 3 || fields[0].empty() || !start || end < start) {
+			fprintf(stderr, "%s:%d: expected queue,start,end,user_id,type\n", path, line_number);
+			fclose(file);
+			return false;
+		}
+		UINT64 user_id = strtoull(fields[3].c_str(), nullptr, 10);
+		out.add(out.get_queue(fields[0]), start, end, user_id, out.types.get(fields[4]));
+	}
+
+	fclose(file);
+	return true;
+}
+
+static bool write_trace(const char *path, const trace& in)
+{
+	FILE *file = fopen(path, "w");
+	if (!file) {
+		fprintf(stderr, "cannot create %s\n", path);
+		return false;
+	}
+	fprintf(file, "# queue,start,end,user_id,type\n");
+	for (auto& record : in.records)
+	{
+		auto type = (const eventviz_aux *)record.UserData;
+		fprintf(file, "%s,%llu,", in.queue_names[record.Queue].c_str(), (unsigned long long)record.Start);
+		if (record.End == UINT64_MAX) {
+			fprintf(file, "dropped,");
+		} else {
+			fprintf(file, "%llu,", (unsigned long long)record.End);
+		}
+		fprintf(file, "%llu,%s\n", (unsigned long long)record.UserID, type ? type->name : "");
+	}
+	fclose(file);
+	return true;
+}
+
+static void write_svg(const char *path, const EventVisualization& visualization, const options& opts)
+{
+	FILE *file = fopen(path, "w");
+	if (!file) {
+		fprintf(stderr, "cannot create %s\n", path);
+		return;
+	}
+	fprintf(file, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%g\" height=\"%g\">\n", opts.width, opts.height);
+	fprintf(file, "<rect width=\"100%%\" height=\"100%%\" fill=\"white\"/>\n");
+	for (auto& r : visualization.Rectangles)
+	{
+		auto type = (const eventviz_aux *)r.Event->UserData;
+		unsigned rgb = type ? (type->r << 16) | (type->g << 8) | type->b : 0;
+		if (r.Flags & Rectangle::Dropped) {
+			fprintf(file, "<polygon points=\"%g,%g %g,%g %g,%g\" fill=\"#%06x\" stroke=\"black\"/>\n",
+				r.Left, r.Top, r.Left, r.Bottom, r.Right, (r.Top + r.Bottom) / 2, rgb);
+		} else {
+			fprintf(file, "<rect x=\"%g\" y=\"%g\" width=\"%g\" height=\"%g\" fill=\"#%06x\" stroke=\"black\"/>\n",
+				r.Left, r.Top, r.Right - r.Left, r.Bottom - r.Top, rgb);
+		}
+	}
+	for (auto& l : visualization.Lines) {
+		fprintf(file, "<line x1=\"%g\" y1=\"%g\" x2=\"%g\" y2=\"%g\" stroke=\"black\"/>\n", l.X0, l.Y0, l.X1, l.Y1);
+	}
+	fprintf(file, "</svg>\n");
+	fclose(file);
+}
+
+static void write_json(const char *path, const EventVisualization& visualization, const trace& in, long frame)
+{
+	FILE *file = fopen(path, "w");
+	if (!file) {
+		fprintf(stderr, "cannot create %s\n", path);
+		return;
+	}
+	fprintf(file, "{\n\"frame\": %ld,\n\"rectangles\": [", frame);
+	const char *separator = "\n";
+	for (auto& r : visualization.Rectangles)
+	{
+		auto& e = *r.Event;
+		auto type = (const eventviz_aux *)e.UserData;
+		fprintf(file, "%s{\"left\": %g, \"top\": %g, \"right\": %g, \"bottom\": %g, \"flags\": %d, \"sequence\": %d, "
+			"\"queue\": \"%s\", \"type\": \"%s\", \"user_id\": %llu, \"start\": %llu, \"end\": %llu}",
+			separator, r.Left, r.Top, r.Right, r.Bottom, r.Flags, r.Sequence,
+			in.queue_names[e.Queue].c_str(), type ? type->name : "",
+			(unsigned long long)e.UserID, (unsigned long long)e.Start, (unsigned long long)e.End);
+		separator = ",\n";
+	}
+	fprintf(file, "\n],\n\"summaries\": [");
+	separator = "\n";
+	for (auto& s : visualization.Summaries) {
+		fprintf(file, "%s{\"rectangle\": %zu, \"count\": %u, \"min_duration\": %llu, \"max_duration\": %llu}",
+			separator, s.Rectangle, s.Count, (unsigned long long)s.MinDuration, (unsigned long long)s.MaxDuration);
+		separator = ",\n";
+	}
+	fprintf(file, "\n],\n\"lines\": [");
+	separator = "\n";
+	for (auto& l : visualization.Lines) {
+		fprintf(file, "%s[%g, %g, %g, %g]", separator, l.X0, l.Y0, l.X1, l.Y1);
+		separator = ",\n";
+	}
+	fprintf(file, "\n]\n}\n");
+	fclose(file);
+}
+
+// Per frame durations of one stage, in microseconds
+struct stage_timings
+{
+	stage_timings(const char *name) : name(name) { }
+
+	const char *name;
+	std::vector<double> samples;
+
+	void print()
+	{
+		if (samples.empty()) {
+			return;
+		}
+		std::vector<double> sorted = samples;
+		std::sort(sorted.begin(), sorted.end());
+		double total = 0;
+		for (double sample : sorted) {
+			total += sample;
+		}
+		auto percentile = [&](double p) { return sorted[size_t(p * (sorted.size() - 1))]; };
+		printf("%-10s mean %9.1f  p50 %9.1f  p99 %9.1f  max %9.1f us\n",
+			name, total / sorted.size(), percentile(0.5), percentile(0.99), sorted.back());
+	}
+};
+
+struct stage_timer
+{
+	stage_timer(stage_timings& timings) : timings(timings), start(std::chrono::steady_clock::now()) { }
+	~stage_timer()
+	{
+		std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+		timings.samples.push_back(elapsed.count());
+	}
+	stage_timings& timings;
+	std::chrono::steady_clock::time_point start;
+};
+
+static void usage()
+{
+	printf(
+		"usage: eviz_cli [options] [trace]\n"
+		"Replays a trace (or a synthetic one, without a trace) through EventViz one\n"
+		"vsync at a time, and reports the time each stage takes per frame.\n"
+		"  --frames N        synthetic: frames to generate (3000)\n"
+		"  --tiny N          synthetic: tiny CPU events per frame (0)\n"
+		"  --user-tracks N   synthetic: user-defined tracks (0)\n"
+		"  --queue-depth N   synthetic: presents queued before waiting for a vsync (3)\n"
+		"  --seed N          synthetic: random seed (42)\n"
+		"  --qpc-freq N      ticks per second of the trace (10000000)\n"
+		"  --window N        vsyncs shown (16)\n"
+		"  --history N       vsyncs kept (256)\n"
+		"  --size WxH        screen size in dips (1024x768)\n"
+		"  --worker          lay out on a LayoutWorker, waiting for each frame\n"
+		"  --frame N         frame to write out (the last one)\n"
+		"  --svg FILE        write the geometry of that frame as SVG\n"
+		"  --json FILE       write the geometry of that frame as JSON\n"
+		"  --write-trace FILE  write the trace that was replayed\n"
+		"  --chrome-trace FILE  export the events as they are committed, as Chrome\n"
+		"                    Trace Event JSON\n"
+		"  --perfetto FILE   the same as a Perfetto protobuf trace\n");
+}
+
+static bool parse_options(int argc, char **argv, options& opts)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+		auto number = [&]() { ++i; return (UINT)strtoul(value, nullptr, 10); };
+
+		if (arg[0] != '-') {
+			opts.trace_path = arg;
+			continue;
+		}
+		if (!strcmp(arg, "--help")) {
+			usage();
+			return false;
+		}
+		if (!strcmp(arg, "--worker")) {
+			opts.worker = true;
+			continue;
+		}
+		if (!value) {
+			usage();
+			return false;
+		}
+
+		if (!strcmp(arg, "--frames")) opts.synthetic.frames = number();
+		else if (!strcmp(arg, "--tiny")) opts.synthetic.tiny_events = number();
+		else if (!strcmp(arg, "--user-tracks")) opts.synthetic.user_tracks = number();
+		else if (!strcmp(arg, "--queue-depth")) opts.synthetic.queue_depth = std::max(1u, number());
+		else if (!strcmp(arg, "--seed")) opts.synthetic.seed = number();
+		else if (!strcmp(arg, "--qpc-freq")) { g_QpcFreq = strtoull(value, nullptr, 10); ++i; }
+		else if (!strcmp(arg, "--window")) opts.window = number();
+		else if (!strcmp(arg, "--history")) opts.history = number();
+		else if (!strcmp(arg, "--frame")) opts.dump_frame = (long)number();
+		else if (!strcmp(arg, "--size")) { sscanf(value, "%fx%f", &opts.width, &opts.height); ++i; }
+		else if (!strcmp(arg, "--svg")) { opts.svg_path = value; ++i; }
+		else if (!strcmp(arg, "--json")) { opts.json_path = value; ++i; }
+		else if (!strcmp(arg, "--write-trace")) { opts.write_trace_path = value; ++i; }
+		else if (!strcmp(arg, "--chrome-trace")) { opts.chrome_trace_path = value; ++i; }
+		else if (!strcmp(arg, "--perfetto")) { opts.perfetto_path = value; ++i; }
+		else {
+			usage();
+			return false;
+		}
+	}
+	return opts.window >= 2 && g_QpcFreq > 0;
+}
+
+int main(int argc, char **argv)
+{
+	options opts;
+	if (!parse_options(argc, argv, opts)) {
+		return 1;
+	}
+
+	trace in;
+	if (opts.trace_path) {
+		if (!read_trace(opts.trace_path, in)) {
+			return 1;
+		}
+	} else {
+		make_synthetic_trace(opts.synthetic, in);
+	}
+	if (opts.write_trace_path && !write_trace(opts.write_trace_path, in)) {
+		return 1;
+	}
+
+	long frame_count = count_frames(in);
+	long dump_frame = opts.dump_frame < 0 ? frame_count - 1 : opts.dump_frame;
+
+	EventStream stream;
+	stream.Pause(false);
+	for (auto& name : in.queue_names) {
+		stream.RegisterQueue(name.c_str());
+	}
+
+	EventVisualization layout; // kept from frame to frame, like the app does
+	LayoutWorker worker;
+	EventViz::FloatRect screen = { 0, 0, opts.width, opts.height };
+
+	enum { MAX_EVIZ_VERTS = 80 * 1024 }; // as in the app
+	std::vector<color_vertex> vertices(MAX_EVIZ_VERTS);
+	std::vector<eviz_instance> instances;
+
+	eviz_trace_writer exports[2];
+	const char *export_paths[2] = { opts.chrome_trace_path, opts.perfetto_path };
+	for (int i = 0; i < 2; ++i) {
+		if (export_paths[i] && !exports[i].open(export_paths[i], i ? EVIZ_TRACE_PERFETTO : EVIZ_TRACE_CHROME_JSON)) {
+			fprintf(stderr, "cannot create %s\n", export_paths[i]);
+			return 1;
+		}
+	}
+	bool exporting = exports[0].is_open() || exports[1].is_open();
+
+	stage_timings commit("commit"), export_trace("export"), lay_out("layout"), build_vertices("vertices"), build_instances("instances");
+	size_t total_rectangles = 0, total_lines = 0, total_merged = 0, max_rectangles = 0;
+	size_t total_vertices = 0, total_instances = 0, full_frames = 0;
+	long frame = 0;
+
+	auto next = in.records.begin();
+	while (next != in.records.end())
+	{
+		// Commit up to and including the next vsync
+		{
+			stage_timer timer(commit);
+			for (; next != in.records.end(); ++next)
+			{
+				auto& record = *next;
+				if (record.Queue == kVsyncQueue) {
+					stream.Vsync(record.Start);
+					++next;
+					break;
+				}
+				stream.InsertEvent(record.Queue, record.Start, record.End, record.UserData, record.UserID);
+			}
+			stream.TrimToLastNVsyncs(opts.history);
+		}
+
+		if (exporting)
+		{
+			stage_timer timer(export_trace);
+			for (auto& writer : exports) {
+				writer.collect(stream);
+			}
+		}
+
+		UINT vsync_count = stream.GetVsyncCount();
+		UINT first_vsync = vsync_count < opts.window ? 0 : vsync_count - opts.window;
+		UINT last_vsync = vsync_count < 1 ? 0 : vsync_count - 1;
+
+		const EventVisualization *visualization = &layout;
+		{
+			stage_timer timer(lay_out);
+			if (opts.worker) {
+				worker.Submit(stream, first_vsync, last_vsync, screen);
+				worker.Wait();
+				visualization = worker.AcquireLatest();
+			} else {
+				CreateVisualization(stream, first_vsync, last_vsync, screen, layout);
+			}
+		}
+
+		{
+			stage_timer timer(build_vertices);
+			eviz_vertex_ranges ranges;
+			total_vertices += build_eviz_vertices(*visualization, vertices.data(), MAX_EVIZ_VERTS, &ranges);
+
+			size_t needed_lines = visualization->Lines.size();
+			for (auto& r : visualization->Rectangles) {
+				needed_lines += (r.Flags & Rectangle::Dropped) ? 3 : 4;
+			}
+			full_frames += ranges.line_count < needed_lines;
+		}
+
+		{
+			stage_timer timer(build_instances);
+			instances.resize(std::max(instances.size(), (size_t)eviz_instance_count(*visualization)));
+			eviz_instance_ranges ranges;
+			total_instances += build_eviz_instances(*visualization, instances.data(), &ranges);
+		}
+
+		total_rectangles += visualization->Rectangles.size();
+		total_lines += visualization->Lines.size();
+		total_merged += visualization->Summaries.size();
+		max_rectangles = std::max(max_rectangles, visualization->Rectangles.size());
+
+		if (frame == dump_frame)
+		{
+			if (opts.svg_path) {
+				write_svg(opts.svg_path, *visualization, opts);
+			}
+			if (opts.json_path) {
+				write_json(opts.json_path, *visualization, in, frame);
+			}
+		}
+		++frame;
+	}
+
+	if (!frame) {
+		fprintf(stderr, "the trace has no vsyncs\n");
+		return 1;
+	}
+
+	printf("%ld frames, %zu events, %zu queues, %s store%s\n", frame, in.records.size(), in.queue_names.size(),
+		EVENTVIZ_COLUMNAR_STORE ? "column" : "timeline", opts.worker ? ", layout worker" : "");
+	printf("per frame: %.1f rectangles (max %zu, %.1f merged), %.1f lines, %.1f vertices, %.1f instances\n",
+		double(total_rectangles) / frame, max_rectangles, double(total_merged) / frame,
+		double(total_lines) / frame, double(total_vertices) / frame, double(total_instances) / frame);
+	if (full_frames) {
+		printf("%zu frames did not fit in %u vertices\n", full_frames, (UINT)MAX_EVIZ_VERTS);
+	}
+	commit.print();
+	export_trace.print();
+	lay_out.print();
+	build_vertices.print();
+	build_instances.print();
+
+	if (exporting)
+	{
+		auto drain_start = std::chrono::steady_clock::now();
+		for (auto& writer : exports) {
+			writer.close(); // waits for the writer thread to catch up
+		}
+		std::chrono::duration<double, std::milli> drain = std::chrono::steady_clock::now() - drain_start;
+		for (int i = 0; i < 2; ++i) {
+			if (export_paths[i]) {
+				printf("%s: %llu events written, %llu lost\n", export_paths[i],
+					(unsigned long long)exports[i].get_written_count(), (unsigned long long)exports[i].get_lost_count());
+			}
+		}
+		printf("export finished %.1fms after the last frame\n", drain.count());
+	}
+	return 0;
+}
@@ -0,0 +1,214 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "EventViz.hpp"
+#include "eviz_vertices.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+// Event traces for the headless tools: eviz_cli replays them, eviz_bench
+// and eviz_test measure and check EventViz on them. A trace is the list of
+// events committed to an EventStream, in commit order, with the queues and
+// event types they refer to.
+
+// Event types, which give the rectangles their color. The first ones are the app's.
+struct type_table
+{
+	type_table()
+	{
+		static const eventviz_aux app_types[] = {
+			{"present call", 0x9A, 0x2E, 0xFE, 0xFF},
+			{"swapchain wait", 0xFF, 0xFF, 0x00, 0xFF},
+			{"render", 0x00, 0xFF, 0x00, 0xFF},
+			{"frame wait", 0x00, 0x00, 0xFF, 0xFF},
+			{"color_0", 0xff, 0x6B, 0x6C, 0xFF},
+			{"color_1", 0x18, 0xC7, 0xFC, 0xFF},
+			{"color_2", 0xF3, 0xAB, 0x00, 0xFF},
+			{"color_3", 0xB3, 0xB1, 0xFF, 0xFF},
+			{"color_4", 0x00, 0xD1, 0xA5, 0xFF},
+			{"color_5", 0xAB, 0xC4, 0x00, 0xFF},
+			{"color_6", 0xFF, 0x93, 0xEE, 0xFF},
+			{"color_7", 0x29, 0xD4, 0x22, 0xFF},
+			{"gpu clear", 0xFF, 0x00, 0x00, 0xFF},
+			{"gpu draw", 0x00, 0xFF, 0x00, 0xFF},
+		};
+		for (auto& type : app_types) {
+			types.push_back(type);
+		}
+	}
+
+	// null for an empty name, which draws black like in the app
+	const eventviz_aux *get(const std::string& name)
+	{
+		if (name.empty()) {
+			return nullptr;
+		}
+		for (auto& type : types) {
+			if (name == type.name) {
+				return &type;
+			}
+		}
+		names.push_back(name);
+		UINT hash = 2166136261u;
+		for (char c : name) {
+			hash = (hash ^ (unsigned char)c) * 16777619u;
+		}
+		eventviz_aux type;
+		type.name = names.back().c_str();
+		type.rgba = hash | 0xff808080; // something light, opaque
+		types.push_back(type);
+		return &types.back();
+	}
+
+	std::deque<eventviz_aux> types; // addresses are the UserData of events
+	std::deque<std::string> names;
+};
+
+struct trace
+{
+	std::deque<std::string> queue_names; // by QueueID
+	std::vector<EventViz::EventData> records; // in commit order
+	type_table types;
+
+	trace()
+	{
+		const char *builtin[] = { "Vsync", "Present", "GPU", "CPU" };
+		for (auto name : builtin) {
+			queue_names.push_back(name);
+		}
+	}
+
+	EventViz::QueueID get_queue(const std::string& name)
+	{
+		for (size_t i = 0; i < queue_names.size(); ++i) {
+			if (queue_names[i] == name) {
+				return EventViz::QueueID(i);
+			}
+		}
+		queue_names.push_back(name);
+		return EventViz::QueueID(queue_names.size() - 1);
+	}
+
+	void add(EventViz::QueueID queue, UINT64 start, UINT64 end, UINT64 user_id, const eventviz_aux *type)
+	{
+		records.push_back({ queue, type, user_id, start, end });
+	}
+};
+
+struct synthetic_options
+{
+	UINT frames = 3000;
+	UINT tiny_events = 0; // per frame
+	UINT user_tracks = 0;
+	UINT queue_depth = 3; // presents queued before the app waits for a vsync
+	UINT seed = 42;
+};
+
+// Something like what the app records: per frame a wait, a render and a
+// present call on the CPU, the GPU work of the previous frame, and a present
+// that is shown at a 60Hz vsync or, now and then, dropped.
+inline void make_synthetic_trace(const synthetic_options& opts, trace& out)
+{
+	using namespace EventViz;
+
+	std::mt19937 rng(opts.seed);
+	UINT64 t = 1000000000;
+	const UINT64 vsync_interval = g_QpcFreq / 60;
+
+	std::vector<QueueID> user_queues;
+	for (UINT i = 0; i < opts.user_tracks; ++i) {
+		user_queues.push_back(out.get_queue("Track " + std::to_string(i)));
+	}
+
+	auto frame_wait = out.types.get("frame wait");
+	auto render = out.types.get("render");
+	auto present_call = out.types.get("present call");
+	auto gpu_draw = out.types.get("gpu draw");
+	auto job = out.types.get("job");
+	auto user = out.types.get("user");
+
+	struct queued_present { UINT64 start, id; const eventviz_aux *type; };
+	std::deque<queued_present> presents;
+	UINT64 next_vsync = t + vsync_interval;
+	UINT64 gpu_start = 0, gpu_end = 0, gpu_id = 0;
+
+	for (UINT64 id = 1; id <= opts.frames; ++id)
+	{
+		UINT64 wait_start = t;
+		t += rng() % 20000;
+		out.add(kCpuQueue, wait_start, t, 0, frame_wait);
+
+		if (gpu_id) {
+			out.add(kGpuQueue, gpu_start, gpu_end, gpu_id, gpu_draw);
+		}
+
+		UINT64 render_start = t;
+		t += 40000 + rng() % 100000;
+		out.add(kCpuQueue, render_start, t, id, render);
+		gpu_start = render_start + 10000;
+		gpu_end = gpu_start + 50000 + rng() % 150000;
+		gpu_id = id;
+
+		for (auto queue : user_queues) {
+			out.add(queue, render_start, render_start + 30000, 0, user);
+		}
+
+		for (UINT i = 0; i < opts.tiny_events; ++i) {
+			UINT64 duration = 1 + rng() % 40;
+			out.add(kCpuQueue, t, t + duration, 0, job);
+			t += duration + rng() % 20;
+		}
+
+		UINT64 call_start = t;
+		t += rng() % 5000;
+		out.add(kCpuQueue, call_start, t, 0, present_call);
+		presents.push_back({ t, id, out.types.get("color_" + std::to_string(id % 8)) });
+
+		// vsyncs until the present queue is short enough again
+		while (next_vsync <= t || presents.size() > opts.queue_depth)
+		{
+			t = std::max(t, next_vsync);
+			if (!presents.empty() && presents.front().start < next_vsync)
+			{
+				auto present = presents.front();
+				presents.pop_front();
+				if (rng() % 50 == 0 && !presents.empty()) {
+					out.add(kPresentQueue, present.start, UINT64_MAX, present.id, present.type);
+					continue;
+				}
+				out.add(kPresentQueue, present.start, next_vsync, present.id, present.type);
+			}
+			out.add(kVsyncQueue, next_vsync, next_vsync, 0, nullptr);
+			next_vsync += vsync_interval;
+		}
+	}
+}
+
+// The number of vsyncs in a trace, which is the number of frames eviz_cli
+// lays out.
+inline long count_frames(const trace& in)
+{
+	long frames = 0;
+	for (auto& record : in.records) {
+		frames += record.Queue == EventViz::kVsyncQueue;
+	}
+	return frames;
+}
@@ -0,0 +1,1537 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+// eviz_test: checks of EventViz, and of the present statistics the sample
+// keeps, that need no window or GPU, mostly on the synthetic traces of
+// eviz_synthetic.hpp.
+//
+// Build from the repository root, on any platform:
+//   g++ -std=c++14 -O2 -ISource Tools/eviz_test.cpp Source/EventViz.cpp Source/eviz_vertices.cpp -lpthread -o eviz_test
+//   cl /EHsc /O2 /ISource Tools\eviz_test.cpp Source\EventViz.cpp Source\eviz_vertices.cpp
+//
+// ./eviz_test runs every test, ./eviz_test recorders ... only those named.
+// It prints each failed check and exits with 1 if there was any. Heap
+// allocations are counted by replacing operator new.
+
+#include "EventViz.hpp"
+#include "eviz_vertices.hpp"
+#include "eviz_synthetic.hpp"
+#include "PresentQueueStats.hpp"
+#include "LatencyHistogram.hpp"
+#include "FramePacing.hpp"
+#define TOOL_COUNT_ALLOCATIONS
+#include "tool_main.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The same vertex code built without SSE2/NEON, to check it as well as the
+// SIMD build
+#undef EVIZ_VERTICES_SIMD
+#define EVIZ_VERTICES_SIMD 0
+namespace scalar {
+#include "eviz_vertices.cpp"
+}
+
+using namespace EventViz;
+
+static int failures = 0;
+
+// Reports a failed check and carries on with the test
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			++failures; \
+		} \
+	} while (0)
+
+/// ----------------------------------------------------------------------
+///                               recorders
+/// ----------------------------------------------------------------------
+
+// Threads record through EventRecorders, some of them creating and
+// destroying recorders as they go, while the owning thread flushes. Every
+// event recorded must end up in the stream, intact and once, or be counted
+// as dropped.
+static void test_recorders()
+{
+	const int thread_count = 8;
+	const UINT events_per_thread = 200000;
+	const UINT events_per_recorder = 5000; // for the threads that come and go
+
+	EventStream stream;
+	stream.Pause(false);
+	std::vector<QueueID> queues;
+	for (int i = 0; i < thread_count; ++i) {
+		queues.push_back(stream.RegisterQueue(("Thread " + std::to_string(i)).c_str()));
+	}
+
+	static const int markers[thread_count] = {};
+	std::atomic<UINT64> dropped(0);
+	std::atomic<int> running(thread_count);
+
+	auto record = [&](int thread) {
+		// The odd threads use a recorder per events_per_recorder events, so
+		// that some of what they record is flushed as orphans.
+		bool churn = thread & 1;
+		std::unique_ptr<EventRecorder> recorder;
+		for (UINT i = 0; i < events_per_thread; ++i)
+		{
+			if (!recorder || (churn && i % events_per_recorder == 0)) {
+				if (recorder) {
+					dropped += recorder->GetDroppedCount();
+				}
+				recorder.reset(new EventRecorder(stream, 256));
+			}
+
+			// Everything about an event follows from its thread and index,
+			// so torn or mixed up records show.
+			UINT64 start = 1000 + i;
+			UINT64 end = start + thread + 1;
+			UINT64 id = (UINT64(thread) << 32) | i;
+			if (i & 1) {
+				recorder->InsertEvent(queues[thread], start, end, &markers[thread], id);
+			} else {
+				auto event = recorder->Start(queues[thread], &markers[thread], id, start);
+				recorder->End(event, end);
+			}
+			if (i % 64 == 0) {
+				std::this_thread::yield();
+			}
+		}
+		dropped += recorder->GetDroppedCount();
+		recorder.reset();
+		--running;
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < thread_count; ++i) {
+		threads.emplace_back(record, i);
+	}
+	while (running) {
+		stream.Flush();
+		std::this_thread::yield();
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	stream.Flush();
+	CHECK(stream.Recorders.empty());
+	CHECK(stream.Orphans.empty());
+
+	std::vector<EventData> records;
+	stream.GetAllEvents(records);
+	std::vector<std::vector<bool>> seen(thread_count, std::vector<bool>(events_per_thread));
+	size_t bad = 0, duplicates = 0;
+	for (auto& record : records)
+	{
+		int thread = int(record.UserID >> 32);
+		UINT i = UINT(record.UserID);
+		if (thread >= thread_count || i >= events_per_thread ||
+			record.Queue != queues[thread] ||
+			record.UserData != &markers[thread] ||
+			record.Start != 1000 + i ||
+			record.End != record.Start + thread + 1)
+		{
+			++bad;
+			continue;
+		}
+		duplicates += seen[thread][i];
+		seen[thread][i] = true;
+	}
+	CHECK(bad == 0);
+	CHECK(duplicates == 0);
+	CHECK(records.size() + dropped == UINT64(thread_count) * events_per_thread);
+	printf("  %zu events merged, %llu dropped\n", records.size(), (unsigned long long)dropped.load());
+}
+
+/// ----------------------------------------------------------------------
+///                                window
+/// ----------------------------------------------------------------------
+
+// Both stores against a brute force filter, on events of every duration
+// class, dropped presents (End == UINT64_MAX) and a few that last for ages.
+template<class Store>
+static void check_store(Store& store)
+{
+	std::mt19937_64 rng(3);
+	std::vector<EventData> events;
+	UINT64 t = 1000;
+	for (UINT64 id = 0; id < 20000; ++id) {
+		t += rng() % 50;
+		UINT64 end;
+		switch (rng() % 10) {
+		case 0: end = t; break;
+		case 1: end = UINT64_MAX; break;
+		case 2: end = t + (rng() % (UINT64(1) << (rng() % 40))); break;
+		case 3: end = rng() % 100 ? t + 5000 : t + 100000000; break;
+		default: end = t + rng() % 100; break;
+		}
+		events.push_back({ kCpuQueue, nullptr, id, t, end });
+	}
+	std::shuffle(events.begin(), events.end(), rng);
+	for (auto& event : events) {
+		store.Insert(event);
+	}
+
+	auto by_start = [](const EventData& a, const EventData& b) {
+		return a.Start < b.Start || (a.Start == b.Start && a.UserID < b.UserID);
+	};
+	std::vector<EventData> live = events;
+	std::sort(live.begin(), live.end(), by_start);
+
+	auto check_queries = [&]() {
+		CHECK(store.Size() == live.size());
+		if (live.empty()) {
+			return;
+		}
+		CHECK(store.GetStart(0) == live.front().Start);
+		CHECK(store.GetStart(live.size() / 2) == live[live.size() / 2].Start);
+
+		UINT64 first = live.front().Start, span = live.back().Start - first + 1;
+		EventSet out;
+		for (int q = 0; q < 300; ++q)
+		{
+			UINT64 from = first + rng() % span;
+			UINT64 to = from + rng() % (UINT64(1) << (rng() % 16));
+			out.clear();
+			store.Gather(from, to, out);
+
+			std::vector<EventData> expected, got;
+			for (auto& event : live) {
+				if (event.Start <= to && VisibleEnd(event.Start, event.End) >= from) {
+					expected.push_back(event);
+				}
+			}
+			bool in_order = true;
+			for (size_t i = 0; i < out.size(); ++i) {
+				got.push_back(*out[i]);
+				in_order &= !i || out[i - 1]->Start <= out[i]->Start;
+			}
+			CHECK(in_order);
+			std::sort(got.begin(), got.end(), by_start);
+			CHECK(got.size() == expected.size());
+			CHECK(std::equal(got.begin(), got.end(), expected.begin(), expected.end(),
+				[](const EventData& a, const EventData& b) { return a.UserID == b.UserID && a.End == b.End; }));
+		}
+	};
+	check_queries();
+
+	UINT64 trim_to = live[live.size() / 4].Start;
+	store.Trim(trim_to);
+	live.erase(live.begin(), std::lower_bound(live.begin(), live.end(), EventData{ 0, nullptr, 0, trim_to, 0 },
+		[](const EventData& a, const EventData& b) { return a.Start < b.Start; }));
+	check_queries();
+
+	// The oldest go, whatever their class; which of the events that start
+	// together goes is up to the store, so the cut is made between starts.
+	size_t kept = live.size() / 2;
+	while (live[live.size() - kept - 1].Start == live[live.size() - kept].Start) {
+		++kept;
+	}
+	store.TrimToSize(kept);
+	live.erase(live.begin(), live.end() - kept);
+	check_queries();
+}
+
+static void test_window()
+{
+	EventTimeline timeline;
+	check_store(timeline);
+	EventColumns columns;
+	columns.Queue = kCpuQueue;
+	check_store(columns);
+}
+
+/// ----------------------------------------------------------------------
+///                                steady
+/// ----------------------------------------------------------------------
+
+// Once the window is full, laying out a steady stream of events reuses what
+// the visualization kept from earlier frames. The trace is replayed three
+// times, each right after the previous one; the first two grow what the
+// layout keeps, windows across the seam included, and the third must not
+// make CreateVisualization touch the heap at all.
+static void test_steady()
+{
+	synthetic_options synthetic;
+	synthetic.frames = 600;
+	synthetic.tiny_events = 100;
+	synthetic.user_tracks = 2;
+	trace in;
+	make_synthetic_trace(synthetic, in);
+
+	// Each pass goes on where the previous one ended, in time and in render IDs
+	UINT64 first = UINT64_MAX, last = 0, last_id = 0;
+	for (auto& record : in.records) {
+		first = std::min(first, record.Start);
+		last = std::max(last, record.Start);
+		last_id = std::max(last_id, record.UserID);
+	}
+	const UINT64 span = last - first + g_QpcFreq;
+
+	EventStream stream;
+	stream.Pause(false);
+	for (auto& name : in.queue_names) {
+		stream.RegisterQueue(name.c_str());
+	}
+	EventVisualization visualization;
+	const FloatRect screen = { 0, 0, 1920, 1080 };
+	const UINT window = 64;
+
+	size_t allocations[3] = {};
+	size_t rectangles = 0;
+	for (int pass = 0; pass < 3; ++pass)
+	{
+		UINT64 offset = pass * span;
+		for (auto& record : in.records)
+		{
+			if (record.Queue != kVsyncQueue) {
+				UINT64 id = record.UserID ? record.UserID + pass * last_id : 0;
+				auto event = stream.Start(record.Queue, record.UserData, id, record.Start + offset);
+				stream.End(event, record.End == UINT64_MAX ? UINT64_MAX : record.End + offset);
+				continue;
+			}
+			stream.Vsync(record.Start + offset);
+			stream.TrimToLastNVsyncs(256);
+
+			UINT vsync_count = stream.GetVsyncCount();
+			if (vsync_count < 2) {
+				continue;
+			}
+			UINT first_vsync = vsync_count <= window ? 0 : vsync_count - window - 1;
+			size_t before = get_allocation_count();
+			CreateVisualization(stream, first_vsync, vsync_count - 1, screen, visualization);
+			allocations[pass] += get_allocation_count() - before;
+			rectangles += visualization.Rectangles.size();
+		}
+	}
+	CHECK(rectangles > 0);
+	CHECK(allocations[2] == 0);
+	printf("  allocations laying out each pass: %zu, %zu, %zu\n", allocations[0], allocations[1], allocations[2]);
+}
+
+/// ----------------------------------------------------------------------
+///                                stacks
+/// ----------------------------------------------------------------------
+
+// The present queue as it was laid out before the stacks shared one array
+// and were kept from frame to frame: every frame, a vector per vsync interval
+// of the presents in it, numbered through a std::map.
+struct reference_layout
+{
+	std::vector<std::vector<EventData*>> stacks;
+	std::map<UINT64, int> sequences;
+
+	void lay_out(EventStream& stream, UINT first_vsync, UINT last_vsync, FloatRect screen,
+		std::vector<Rectangle>& out)
+	{
+		const int line_height = 33, padding = 33;
+		out.clear();
+
+		std::vector<UINT64> vsyncs;
+		for (UINT i = first_vsync; i <= last_vsync; ++i) {
+			vsyncs.push_back(stream.GetVsyncTime(i));
+		}
+		UINT64 start_time = vsyncs.front(), end_time = vsyncs.back();
+		EventSet events;
+		stream.Tracks[kPresentQueue].Events.Gather(start_time, end_time, events);
+
+		// Scatter each event into every interval that it intersects
+		int K = int(vsyncs.size());
+		stacks.assign(K - 1, std::vector<EventData*>());
+		UINT rows = 0;
+		for (size_t e = 0; e < events.size(); ++e)
+		{
+			auto event = events[e];
+			UINT64 end = event->End == UINT64_MAX ? event->Start : event->End;
+			int first = std::max(0, int(std::lower_bound(vsyncs.begin(), vsyncs.end(), event->Start) - vsyncs.begin() - 1));
+			int last = std::min(K - 1, int(std::upper_bound(vsyncs.begin(), vsyncs.end(), end) - vsyncs.begin()));
+			for (int i = first; i < last; ++i) {
+				if (vsyncs[i] < end) {
+					stacks[i].push_back(event);
+					rows = std::max(rows, UINT(stacks[i].size()));
+				}
+			}
+		}
+
+		// Where CreateVisualization puts the present queue: above the user
+		// tracks, the CPU and the GPU queues
+		FloatRect rect;
+		rect.Left = screen.Left + padding;
+		rect.Right = screen.Right - padding;
+		UINT64 time_width = end_time - start_time + 1;
+		float pixel_width = rect.Right - rect.Left + 1;
+		float time_to_pixels = pixel_width / time_width;
+		float y = screen.Bottom;
+		for (QueueID queue = kBuiltinQueueCount; queue < stream.GetQueueCount(); ++queue) {
+			y -= line_height + padding;
+		}
+		y -= 2 * (line_height + padding);
+		rect.Top = y - rows*line_height;
+		rect.Bottom = y;
+
+		sequences.clear();
+		for (int i = 0; i < K - 1; ++i)
+		{
+			auto& stack = stacks[i];
+			UINT size = UINT(stack.size());
+			UINT lift = rows - size;
+			for (UINT j = 0; j < size; ++j) {
+				auto event = stack[size - 1 - j];
+				float y0 = rect.Bottom - (j + 1 + lift)*line_height;
+				float y1 = rect.Bottom - (j + lift)*line_height;
+				float x0 = rect.Left + time_to_pixels * INT64(std::max(event->Start, vsyncs[i]) - start_time);
+				float x1 = rect.Left + time_to_pixels * INT64(std::min(event->End, vsyncs[i + 1]) - start_time);
+				int flags = 0;
+				if (event->Start >= vsyncs[i] && event->Start <= vsyncs[i + 1]) {
+					flags |= Rectangle::Primary;
+				}
+				if (event->End == UINT64_MAX) {
+					flags |= Rectangle::Dropped;
+				}
+				out.push_back({ x0, y0, x1, y1, event, flags, ++sequences[event->UserID] });
+			}
+		}
+
+		// The display row above it: the present at the bottom of a stack is
+		// shown for the next interval
+		y = rect.Top - padding;
+		rect.Top = y - line_height;
+		rect.Bottom = y;
+		EventData *display = nullptr;
+		int flags = 0;
+		for (int i = 0; i < K - 1; ++i)
+		{
+			if (display) {
+				float x0 = rect.Left + time_to_pixels * INT64(vsyncs[i] - start_time);
+				float x1 = rect.Left + time_to_pixels * INT64(vsyncs[i + 1] - start_time);
+				out.push_back({ x0, rect.Top, x1, rect.Bottom, display, flags, ++sequences[display->UserID] });
+				flags = 0;
+			}
+			if (!stacks[i].empty()) {
+				display = stacks[i][0];
+				flags = Rectangle::Primary;
+			}
+		}
+	}
+};
+
+// The present and display rectangles of CreateVisualization, frame after
+// frame, against those of the reference: the same rectangles, in the same
+// order, for the same events. Synthetic traces as eviz_cli makes them, with
+// busy CPU and user tracks, and with deeper present queues.
+static void test_stacks()
+{
+	struct variant { UINT tiny_events, user_tracks, queue_depth, window, history; };
+	const variant variants[] = {
+		{ 0, 0, 3, 16, 256 },
+		{ 50, 2, 3, 16, 256 },
+		{ 0, 0, 3, 240, 256 },
+		{ 0, 1, 8, 64, 96 },
+		{ 0, 0, 32, 64, 128 },
+	};
+	const FloatRect screen = { 0, 0, 1024, 768 };
+	size_t compared = 0;
+	for (auto& v : variants)
+	{
+		synthetic_options synthetic;
+		synthetic.frames = 600;
+		synthetic.tiny_events = v.tiny_events;
+		synthetic.user_tracks = v.user_tracks;
+		synthetic.queue_depth = v.queue_depth;
+		trace in;
+		make_synthetic_trace(synthetic, in);
+
+		EventStream stream;
+		stream.Pause(false);
+		for (auto& name : in.queue_names) {
+			stream.RegisterQueue(name.c_str());
+		}
+		EventVisualization visualization;
+		reference_layout reference;
+		std::vector<Rectangle> expected, got;
+		size_t mismatched_frames = 0;
+		for (auto& record : in.records)
+		{
+			if (record.Queue != kVsyncQueue) {
+				stream.InsertEvent(record.Queue, record.Start, record.End, record.UserData, record.UserID);
+				continue;
+			}
+			stream.Vsync(record.Start);
+			stream.TrimToLastNVsyncs(v.history);
+
+			UINT vsync_count = stream.GetVsyncCount();
+			if (vsync_count < 2) {
+				continue;
+			}
+			UINT first_vsync = vsync_count < v.window ? 0 : vsync_count - v.window;
+			CreateVisualization(stream, first_vsync, vsync_count - 1, screen, visualization);
+			reference.lay_out(stream, first_vsync, vsync_count - 1, screen, expected);
+
+			got.clear();
+			for (auto& r : visualization.Rectangles) {
+				if (r.Event->Queue == kPresentQueue) {
+					got.push_back(r);
+				}
+			}
+			bool same = got.size() == expected.size();
+			for (size_t i = 0; same && i < got.size(); ++i) {
+				auto& a = got[i];
+				auto& b = expected[i];
+				same = a.Left == b.Left && a.Top == b.Top && a.Right == b.Right && a.Bottom == b.Bottom &&
+					a.Flags == b.Flags && a.Sequence == b.Sequence &&
+					a.Event->UserID == b.Event->UserID && a.Event->Start == b.Event->Start && a.Event->End == b.Event->End;
+			}
+			mismatched_frames += !same;
+			compared += got.size();
+		}
+		CHECK(mismatched_frames == 0);
+	}
+	CHECK(compared > 0);
+	printf("  %zu present and display rectangles compared\n", compared);
+}
+
+/// ----------------------------------------------------------------------
+///                                  lod
+/// ----------------------------------------------------------------------
+
+// The rectangles of the linear queues against the events they were laid out
+// from: clipped to the queue's rectangle, no more of them than the width in
+// pixels allows, every visible event drawn or counted in the summary of the
+// Merged rectangle it went into, and every event with a UserID, which links
+// may need, drawn as a rectangle of its own.
+static void test_lod()
+{
+	struct variant { UINT tiny_events, window; float width; };
+	const variant variants[] = {
+		{ 0, 16, 1024 },
+		{ 1000, 16, 1024 },
+		{ 1000, 240, 1024 },
+		{ 5000, 64, 640 },
+		{ 0, 240, 640 }, // GPU events narrower than a pixel
+	};
+	const int padding = 33;
+	size_t checked = 0, merged = 0;
+	for (auto& v : variants)
+	{
+		synthetic_options synthetic;
+		synthetic.frames = 150;
+		synthetic.tiny_events = v.tiny_events;
+		synthetic.user_tracks = 2;
+		trace in;
+		make_synthetic_trace(synthetic, in);
+
+		EventStream stream;
+		stream.Pause(false);
+		for (auto& name : in.queue_names) {
+			stream.RegisterQueue(name.c_str());
+		}
+		const FloatRect screen = { 0, 0, v.width, 768 };
+		EventVisualization visualization;
+		std::vector<EventData> records;
+		size_t outside = 0, too_many = 0, miscounted = 0, unlinked = 0, bad_summaries = 0;
+		UINT frame = 0;
+		for (auto& record : in.records)
+		{
+			if (record.Queue != kVsyncQueue) {
+				stream.InsertEvent(record.Queue, record.Start, record.End, record.UserData, record.UserID);
+				continue;
+			}
+			stream.Vsync(record.Start);
+			stream.TrimToLastNVsyncs(256);
+			UINT vsync_count = stream.GetVsyncCount();
+			if (vsync_count < 2 || ++frame % 10) {
+				continue;
+			}
+			UINT first_vsync = vsync_count < v.window ? 0 : vsync_count - v.window;
+			CreateVisualization(stream, first_vsync, vsync_count - 1, screen, visualization);
+			++checked;
+
+			// How CreateVisualization maps time to pixels
+			UINT64 start_time = stream.GetVsyncTime(first_vsync);
+			UINT64 end_time = stream.GetVsyncTime(vsync_count - 1);
+			float left = screen.Left + padding, right = screen.Right - padding;
+			float pixel_width = right - left + 1;
+			float time_to_pixels = pixel_width / (end_time - start_time + 1);
+
+			auto& rectangles = visualization.Rectangles;
+			std::vector<UINT> counts(rectangles.size(), 1);
+			for (auto& s : visualization.Summaries) {
+				bool valid = s.Rectangle < rectangles.size() && (rectangles[s.Rectangle].Flags & Rectangle::Merged) &&
+					s.Count > 1 && s.MinDuration <= s.MaxDuration;
+				bad_summaries += !valid;
+				if (valid) {
+					counts[s.Rectangle] = s.Count;
+				}
+			}
+			merged += visualization.Summaries.size();
+
+			records.clear();
+			stream.GetAllEvents(records);
+			for (QueueID queue = kGpuQueue; queue < stream.GetQueueCount(); ++queue)
+			{
+				size_t drawn = 0, counted = 0;
+				std::vector<const EventData*> own;
+				for (size_t i = 0; i < rectangles.size(); ++i) {
+					auto& r = rectangles[i];
+					if (r.Event->Queue != queue) {
+						continue;
+					}
+					outside += r.Left < left || r.Right > right;
+					++drawn;
+					counted += counts[i];
+					own.push_back(r.Event);
+				}
+				too_many += drawn > 2 * size_t(pixel_width);
+
+				size_t visible = 0;
+				for (auto& event : records) {
+					if (event.Queue != queue || event.Start > end_time || VisibleEnd(event.Start, event.End) < start_time) {
+						continue;
+					}
+					float x0 = std::max(left + time_to_pixels * INT64(event.Start - start_time), left);
+					float x1 = std::min(left + time_to_pixels * INT64(event.End - start_time), right);
+					if (x1 < x0) {
+						continue;
+					}
+					++visible;
+					if (event.UserID) {
+						unlinked += std::none_of(own.begin(), own.end(), [&](const EventData *e) {
+							return e->UserID == event.UserID && e->Start == event.Start;
+						});
+					}
+				}
+				miscounted += counted != visible;
+			}
+		}
+		CHECK(outside == 0);
+		CHECK(too_many == 0);
+		CHECK(miscounted == 0);
+		CHECK(unlinked == 0);
+		CHECK(bad_summaries == 0);
+	}
+	CHECK(merged > 0);
+	printf("  %zu frames checked, %zu merged rectangles\n", checked, merged);
+}
+
+/// ----------------------------------------------------------------------
+///                                worker
+/// ----------------------------------------------------------------------
+
+static bool same_layout(const EventVisualization& a, const EventVisualization& b)
+{
+	if (a.Rectangles.size() != b.Rectangles.size() || a.Lines.size() != b.Lines.size() ||
+		a.Summaries.size() != b.Summaries.size())
+	{
+		return false;
+	}
+	for (size_t i = 0; i < a.Rectangles.size(); ++i) {
+		auto& r = a.Rectangles[i];
+		auto& s = b.Rectangles[i];
+		if (r.Left != s.Left || r.Top != s.Top || r.Right != s.Right || r.Bottom != s.Bottom ||
+			r.Flags != s.Flags || r.Sequence != s.Sequence ||
+			r.Event->Queue != s.Event->Queue || r.Event->UserData != s.Event->UserData ||
+			r.Event->UserID != s.Event->UserID || r.Event->Start != s.Event->Start || r.Event->End != s.Event->End)
+		{
+			return false;
+		}
+	}
+	for (size_t i = 0; i < a.Lines.size(); ++i) {
+		if (memcmp(&a.Lines[i], &b.Lines[i], sizeof(Line))) {
+			return false;
+		}
+	}
+	for (size_t i = 0; i < a.Summaries.size(); ++i) {
+		auto& p = a.Summaries[i];
+		auto& q = b.Summaries[i];
+		if (p.Rectangle != q.Rectangle || p.Count != q.Count ||
+			p.MinDuration != q.MinDuration || p.MaxDuration != q.MaxDuration)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// What a LayoutWorker lays out from its copy of the stream against what
+// CreateVisualization lays out from the stream itself, after every Submit.
+// Frames commit more than the commit log holds, some frames are not
+// submitted at all, the history is trimmed and bounded, and the worker is
+// moved from one stream to another and back.
+static void test_worker()
+{
+	synthetic_options synthetic;
+	synthetic.frames = 60;
+	synthetic.tiny_events = 5000;
+	synthetic.user_tracks = 2;
+	trace traces[2];
+	make_synthetic_trace(synthetic, traces[0]);
+	synthetic.seed = 7;
+	synthetic.user_tracks = 3;
+	make_synthetic_trace(synthetic, traces[1]);
+
+	EventStream streams[2];
+	EventVisualization inline_layouts[2];
+	size_t next[2] = {};
+	for (int s = 0; s < 2; ++s) {
+		streams[s].Pause(false);
+		for (auto& name : traces[s].queue_names) {
+			streams[s].RegisterQueue(name.c_str());
+		}
+	}
+	streams[0].SetHistoryCapacity(100000);
+
+	std::unique_ptr<LayoutWorker> worker_owner(new LayoutWorker);
+	LayoutWorker& worker = *worker_owner;
+	const FloatRect screen = { 0, 0, 1280, 720 };
+	size_t submitted = 0, mismatched = 0, most_commits = 0;
+	for (int frame = 0; next[0] < traces[0].records.size() || next[1] < traces[1].records.size(); ++frame)
+	{
+		for (int s = 0; s < 2; ++s) {
+			UINT64 before = streams[s].GetCommitCount();
+			auto& records = traces[s].records;
+			for (; next[s] < records.size(); ++next[s]) {
+				auto& record = records[next[s]];
+				if (record.Queue == kVsyncQueue) {
+					streams[s].Vsync(record.Start);
+					++next[s];
+					break;
+				}
+				streams[s].InsertEvent(record.Queue, record.Start, record.End, record.UserData, record.UserID);
+			}
+			streams[s].TrimToLastNVsyncs(24);
+			most_commits = std::max(most_commits, size_t(streams[s].GetCommitCount() - before));
+		}
+
+		if (frame % 7 == 3) {
+			continue; // not submitted; the next Submit brings both frames
+		}
+		int s = frame >= 20 && frame < 40 ? 1 : 0;
+		EventStream& stream = streams[s];
+		UINT vsync_count = stream.GetVsyncCount();
+		if (vsync_count < 2) {
+			continue;
+		}
+		UINT first_vsync = vsync_count < 16 ? 0 : vsync_count - 16;
+		worker.Submit(stream, first_vsync, vsync_count - 1, screen);
+		worker.Wait();
+		auto laid_out = worker.AcquireLatest();
+		CreateVisualization(stream, first_vsync, vsync_count - 1, screen, inline_layouts[s]);
+		mismatched += !laid_out || !same_layout(*laid_out, inline_layouts[s]);
+		++submitted;
+		// Only the stream submitted last is followed
+		CHECK(stream.Sinks.size() == 1 && streams[1 - s].Sinks.empty());
+	}
+	worker_owner.reset();
+	CHECK(streams[0].Sinks.empty() && streams[1].Sinks.empty());
+	CHECK(most_commits > EventStream::kCommitLogSize);
+	CHECK(submitted > 40);
+	CHECK(mismatched == 0);
+	printf("  %zu layouts compared, up to %zu commits a frame\n", submitted, most_commits);
+}
+
+/// ----------------------------------------------------------------------
+///                               vertices
+/// ----------------------------------------------------------------------
+
+// The vertex builders as they were before they wrote each vertex once, with
+// SIMD: copied from sample_dx12.cpp as they were, but for a '.' after the
+// backslash that ended a comment line, and driven the way build_eviz_display
+// drove them. Both builds of build_eviz_vertices must match them.
+namespace old_builders {
+
+// two vertices
+static void build_eviz_line(color_vertex *v, const EventViz::Line& line)
+{
+	memset(v, 0, 2 * sizeof(color_vertex));
+
+	UINT color = 0xff000000; // black, full alpha;
+
+	auto X0 = float(line.X0);
+	auto Y0 = float(line.Y0);
+	auto X1 = float(line.X1);
+	auto Y1 = float(line.Y1);
+
+	v[0].x = X0;
+	v[0].y = Y0;
+	v[0].rgba = color;
+
+	v[1].x = X1;
+	v[1].y = Y1;
+	v[1].rgba = color;
+}
+
+static int build_line_joints(color_vertex *v, const EventViz::Line& line)
+{
+	memset(v, 0, 12 * sizeof(color_vertex));
+
+	UINT black = 0xff000000; // black, full alpha;
+
+	if (line.X0 == line.X1) {
+		return 0;
+	}
+
+	float x[2] = { float(line.X0), float(line.X1) };
+	float y[2] = { float(line.Y0), float(line.Y1) };
+
+	for (int i = 0; i < 2; ++i)
+	{
+		float left = x[i] - 1.5f;
+		float right = x[i] + 1.5f;
+		float top = y[i] - 1.5f;
+		float bottom = y[i] + 1.5f;
+
+		v[0].x = left;
+		v[0].y = bottom;
+		v[0].rgba = black;
+
+		v[1].x = left;
+		v[1].y = top;
+		v[1].rgba = black;
+
+		v[2].x = right;
+		v[2].y = bottom;
+		v[2].rgba = black;
+
+		v[3].x = left;
+		v[3].y = top;
+		v[3].rgba = black;
+
+		v[4].x = right;
+		v[4].y = bottom;
+		v[4].rgba = black;
+
+		v[5].x = right;
+		v[5].y = top;
+		v[5].rgba = black;
+
+		v += 6;
+	}
+
+	return 4;
+}
+
+static int build_eviz_quad(color_vertex *v, const EventViz::Rectangle& r)
+{
+	memset(v, 0, 6*sizeof(color_vertex));
+
+	auto data = (eventviz_aux *)r.Event->UserData;
+
+	UINT rgba = data ? data->rgba : 0xff000000;
+	UINT left_color = rgba;
+	//UINT right_color = rgba;
+	//UINT right_color = ((rgba >> 1) & 0x007f7f7f) | 0xff000000; // half brightness
+	UINT right_color = (((rgba >> 3) & 0x001f1f1f) * 7) | 0xff000000; // 7/8th brightness
+
+	float left = float(r.Left);
+	float top = float(r.Top);
+	float right = float(r.Right);
+	float bottom = float(r.Bottom);
+
+	if (r.Flags & EventViz::Rectangle::Dropped)
+	{
+		// +
+		// | \.
+		// +---+
+		// | / 
+		// +
+
+		float mid = (top + bottom) / 2;
+
+		// bottom half
+		v[0].x = left;
+		v[0].y = bottom;
+		v[0].rgba = left_color;
+		v[1].x = left;
+		v[1].y = top;
+		v[1].rgba = left_color;
+		v[2].x = right;
+		v[2].y = mid;
+		v[2].rgba = right_color;
+
+		return 1;
+	}
+	else
+	{
+		// 1---3
+		// | \ |
+		// 0---2
+
+		v[0].x = left;
+		v[0].y = bottom;
+		v[0].rgba = left_color;
+
+		v[1].x = left;
+		v[1].y = top;
+		v[1].rgba = left_color;
+
+		v[2].x = right;
+		v[2].y = bottom;
+		v[2].rgba = right_color;
+
+		// ---------------------
+
+		v[3].x = left;
+		v[3].y = top;
+		v[3].rgba = left_color;
+
+		v[4].x = right;
+		v[4].y = bottom;
+		v[4].rgba = right_color;
+
+		v[5].x = right;
+		v[5].y = top;
+		v[5].rgba = right_color;
+
+		return 2;
+	}
+}
+
+static int build_eviz_quad_outlines(color_vertex *v, const EventViz::Rectangle& r)
+{
+	memset(v, 0, 8 * sizeof(color_vertex));
+
+	UINT black = 0xff000000;
+
+	float x[2] = { float(r.Left), float(r.Right) };
+	float y[2] = { float(r.Top), float(r.Bottom) };
+
+	if (r.Flags & EventViz::Rectangle::Dropped)
+	{
+		v[0 + 0].x = x[0];
+		v[0 + 0].y = y[0];
+		v[0 + 0].rgba = black;
+		v[0 + 1].x = x[0];
+		v[0 + 1].y = y[1];
+		v[0 + 1].rgba = black;
+		v[2 + 0].x = x[0];
+		v[2 + 0].y = y[0];
+		v[2 + 0].rgba = black;
+		v[2 + 1].x = x[1];
+		v[2 + 1].y = (y[0] + y[1]) / 2;
+		v[2 + 1].rgba = black;
+		v[4 + 0].x = x[0];
+		v[4 + 0].y = y[1];
+		v[4 + 0].rgba = black;
+		v[4 + 1].x = x[1];
+		v[4 + 1].y = (y[0] + y[1]) / 2;
+		v[4 + 1].rgba = black;
+		return 3;
+	}
+	else
+	{
+		for (int segment = 0; segment < 4; ++segment) {
+			int xi0 = (0b0110 >> segment) & 1;
+			int xi1 = (0b0011 >> segment) & 1;
+			int yi0 = (0b1100 >> segment) & 1;
+			int yi1 = (0b0110 >> segment) & 1;
+			v[2 * segment + 0].x = x[xi0];
+			v[2 * segment + 0].y = y[yi0];
+			v[2 * segment + 0].rgba = black;
+			v[2 * segment + 1].x = x[xi1];
+			v[2 * segment + 1].y = y[yi1];
+			v[2 * segment + 1].rgba = black;
+		}
+		return 4;
+	}
+}
+
+static UINT build_eviz_display(const EventVisualization& visualization,
+	color_vertex *write, UINT MAX_EVIZ_VERTS, eviz_vertex_ranges *ranges)
+{
+	UINT vertex_count = 0;
+
+	UINT *eviz_tri_start = &ranges->tri_start, *eviz_tri_count = &ranges->tri_count;
+	UINT *eviz_line_start = &ranges->line_start, *eviz_line_count = &ranges->line_count;
+	*ranges = {};
+
+	*eviz_tri_start = vertex_count;
+	*eviz_tri_count = 0;
+
+	auto nr = visualization.Rectangles.size();
+	auto rs = visualization.Rectangles.data();
+
+	auto nl = visualization.Lines.size();
+	auto ls = visualization.Lines.data();
+
+	// rectangles
+	for (size_t i = 0; i < nr; ++i)
+	{
+		if (vertex_count + 6 >= MAX_EVIZ_VERTS) {
+			goto overflow;
+		}
+		int tris = build_eviz_quad(&write[vertex_count], rs[i]);
+		vertex_count += 3 * tris;
+		*eviz_tri_count += tris;
+	}
+
+	// line joints
+	for (size_t i = 0; i < nl; ++i)
+	{
+		if (vertex_count + 12 > MAX_EVIZ_VERTS) {
+			goto overflow;
+		}
+		int tris = build_line_joints(&write[vertex_count], ls[i]);
+		vertex_count += 3*tris;
+		*eviz_tri_count += tris;
+	}
+
+	*eviz_line_start = vertex_count;
+	*eviz_line_count = 0;
+
+	// rectangle outlines
+	for (size_t i = 0; i < nr; ++i)
+	{
+		if (vertex_count + 8 >= MAX_EVIZ_VERTS) {
+			goto overflow;
+		}
+		int lines = build_eviz_quad_outlines(&write[vertex_count], rs[i]);
+		vertex_count += 2*lines;
+		*eviz_line_count += lines;
+	}
+
+	// lines
+	for (size_t i = 0; i < nl; ++i)
+	{
+		if (vertex_count + 2 >= MAX_EVIZ_VERTS) {
+			goto overflow;
+		}
+		build_eviz_line(&write[vertex_count], ls[i]);
+		vertex_count += 2;
+		*eviz_line_count += 1;
+	}
+
+overflow:
+
+	return vertex_count;
+}
+
+}
+
+// Compares the vertices of both builds with the old builders', byte for
+// byte: each buffer starts out filled with something else, so a field a
+// build leaves unwritten shows.
+static bool same_vertices(const EventVisualization& visualization, UINT capacity)
+{
+	std::vector<color_vertex> old_vertices(capacity + 16), simd_vertices(capacity + 16), scalar_vertices(capacity + 16);
+	memset(old_vertices.data(), 0x55, old_vertices.size() * sizeof(color_vertex));
+	memset(simd_vertices.data(), 0x00, simd_vertices.size() * sizeof(color_vertex));
+	memset(scalar_vertices.data(), 0xff, scalar_vertices.size() * sizeof(color_vertex));
+	eviz_vertex_ranges old_ranges, simd_ranges, scalar_ranges;
+	UINT old_count = old_builders::build_eviz_display(visualization, old_vertices.data(), capacity, &old_ranges);
+	UINT simd_count = build_eviz_vertices(visualization, simd_vertices.data(), capacity, &simd_ranges);
+	UINT scalar_count = scalar::build_eviz_vertices(visualization, scalar_vertices.data(), capacity, &scalar_ranges);
+	return simd_count == old_count && scalar_count == old_count &&
+		!memcmp(&simd_ranges, &old_ranges, sizeof(old_ranges)) &&
+		!memcmp(&scalar_ranges, &old_ranges, sizeof(old_ranges)) &&
+		!memcmp(simd_vertices.data(), old_vertices.data(), old_count * sizeof(color_vertex)) &&
+		!memcmp(scalar_vertices.data(), old_vertices.data(), old_count * sizeof(color_vertex));
+}
+
+// Compares what expand_eviz_instances makes of the instances of a
+// visualization, as eviz_vertex_shader would draw them, with the vertices
+// build_eviz_vertices makes of it, the same way as same_vertices.
+static bool same_expanded(const EventVisualization& visualization, UINT capacity)
+{
+	std::vector<eviz_instance> instances(eviz_instance_count(visualization));
+	eviz_instance_ranges instance_ranges;
+	UINT instance_count = build_eviz_instances(visualization, instances.data(), &instance_ranges);
+
+	std::vector<color_vertex> built(capacity + 16), expanded(capacity + 16);
+	memset(built.data(), 0x00, built.size() * sizeof(color_vertex));
+	memset(expanded.data(), 0xff, expanded.size() * sizeof(color_vertex));
+	eviz_vertex_ranges built_ranges, expanded_ranges;
+	UINT built_count = build_eviz_vertices(visualization, built.data(), capacity, &built_ranges);
+	UINT expanded_count = expand_eviz_instances(instances.data(), instance_ranges, expanded.data(), capacity, &expanded_ranges);
+	return instance_count == instances.size() &&
+		built_count == expanded_count &&
+		!memcmp(&built_ranges, &expanded_ranges, sizeof(built_ranges)) &&
+		!memcmp(built.data(), expanded.data(), built_count * sizeof(color_vertex));
+}
+
+// Two ways of making vertices, compared by Same on the frames of synthetic
+// traces, on rectangles and lines anywhere, inverted and of every flag, and
+// with buffers too small for all of them.
+template<bool (*Same)(const EventVisualization&, UINT)>
+static void check_vertices()
+{
+	const FloatRect screen = { 0, 0, 1920, 1080 };
+	size_t frames = 0, mismatched = 0;
+	for (UINT window : { 16u, 240u })
+	{
+		synthetic_options synthetic;
+		synthetic.frames = 400;
+		synthetic.tiny_events = 50;
+		synthetic.user_tracks = 2;
+		trace in;
+		make_synthetic_trace(synthetic, in);
+
+		EventStream stream;
+		stream.Pause(false);
+		for (auto& name : in.queue_names) {
+			stream.RegisterQueue(name.c_str());
+		}
+		EventVisualization visualization;
+		for (auto& record : in.records)
+		{
+			if (record.Queue != kVsyncQueue) {
+				stream.InsertEvent(record.Queue, record.Start, record.End, record.UserData, record.UserID);
+				continue;
+			}
+			stream.Vsync(record.Start);
+			stream.TrimToLastNVsyncs(256);
+			UINT vsync_count = stream.GetVsyncCount();
+			if (vsync_count < 2) {
+				continue;
+			}
+			CreateVisualization(stream, vsync_count < window ? 0 : vsync_count - window, vsync_count - 1, screen, visualization);
+			UINT capacity = UINT(16 * (visualization.Rectangles.size() + visualization.Lines.size()));
+			mismatched += !Same(visualization, capacity);
+			++frames;
+		}
+	}
+	CHECK(frames > 0);
+	CHECK(mismatched == 0);
+
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> coordinate(-5000, 5000);
+	eventviz_aux type = { "type", { { 0x12, 0x34, 0x56, 0x78 } } };
+	std::vector<EventData> events(2);
+	events[0].UserData = nullptr;
+	events[1].UserData = &type;
+	EventVisualization visualization;
+	for (int i = 0; i < 1000; ++i) {
+		Rectangle r = { coordinate(rng), coordinate(rng), coordinate(rng), coordinate(rng),
+			&events[rng() % 2], int(rng() % 8), 0 };
+		visualization.Rectangles.push_back(r);
+		visualization.Lines.push_back({ coordinate(rng), coordinate(rng), coordinate(rng), coordinate(rng) });
+	}
+	size_t random_mismatched = 0;
+	for (UINT capacity : { 0u, 5u, 6u, 7u, 100u, 6007u, 14000u, 30000u }) {
+		random_mismatched += !Same(visualization, capacity);
+	}
+	CHECK(random_mismatched == 0);
+	printf("  %zu frames and 8 random sets compared\n", frames);
+}
+
+// Both builds against the old builders
+static void test_vertices()
+{
+	check_vertices<same_vertices>();
+}
+
+// The instanced path draws what the vertex path draws
+static void test_instances()
+{
+	check_vertices<same_expanded>();
+}
+
+/// ----------------------------------------------------------------------
+///                                latency
+/// ----------------------------------------------------------------------
+
+// LatencyStatistics against the same windows recomputed from scratch: the
+// samples of the last kCapacity that are younger than the window. Stretches
+// of latencies a million times the others are where removing samples from
+// running moments loses precision, and a stretch at 1000Hz overflows the
+// ring of the 60 second window.
+static void test_latency()
+{
+	static const UINT window_seconds[LatencyStatistics::kWindowCount] = { 1, 10, 60 };
+	const UINT capacity = LatencyStatistics::kCapacity;
+	const UINT sample_count = 2000000;
+
+	std::unique_ptr<LatencyStatistics> stats(new LatencyStatistics);
+	std::deque<std::pair<UINT64, double>> recent; // time and latency of the last capacity samples
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<double> noise(0, 1);
+	UINT64 time = SecondsToQpcTime(1);
+	size_t checks = 0, bad_counts = 0, bad_means = 0, bad_deviations = 0, bad_ranges = 0;
+	double worst_deviation_error = 0;
+
+	for (UINT i = 0; i < sample_count; ++i)
+	{
+		bool fast = i % 500000 >= 400000;
+		time += fast ? SecondsToQpcTime(0.001) : SecondsToQpcTime(1 / 240.0);
+		double latency = (i / 50000 % 2 ? 1e6 : 20) + 5 * noise(rng);
+		stats->Sample(latency, time);
+		recent.emplace_back(time, latency);
+		if (recent.size() > capacity) {
+			recent.pop_front();
+		}
+
+		if (i % 997) {
+			continue;
+		}
+		++checks;
+		for (int w = 0; w < LatencyStatistics::kWindowCount; ++w)
+		{
+			auto which = LatencyStatistics::Window(w);
+			UINT64 duration = SecondsToQpcTime(window_seconds[w]);
+			auto first = recent.end();
+			while (first != recent.begin() && time - (first - 1)->first < duration) {
+				--first;
+			}
+			size_t count = recent.end() - first;
+			double sum = 0, lowest = first->second, highest = first->second;
+			for (auto it = first; it != recent.end(); ++it) {
+				sum += it->second;
+				lowest = std::min(lowest, it->second);
+				highest = std::max(highest, it->second);
+			}
+			double mean = sum / count, squares = 0;
+			for (auto it = first; it != recent.end(); ++it) {
+				squares += (it->second - mean) * (it->second - mean);
+			}
+			double deviation = sqrt(squares / count);
+
+			double deviation_error = fabs(stats->EvaluateStdDevMetric(which) - deviation);
+			worst_deviation_error = std::max(worst_deviation_error, deviation_error);
+			bad_counts += stats->GetSampleCount(which) != count;
+			bad_means += fabs(stats->EvaluateMean(which) - mean) > 1e-9 * (1 + fabs(mean));
+			bad_deviations += deviation_error > 1e-6 * (1 + deviation);
+			bad_ranges += stats->EvaluateMinMaxMetric(which) != highest - lowest;
+		}
+	}
+	CHECK(stats->GetEvictedCount() > 0);
+	CHECK(bad_counts == 0);
+	CHECK(bad_means == 0);
+	CHECK(bad_deviations == 0);
+	CHECK(bad_ranges == 0);
+	printf("  %zu checks of 3 windows, std. dev. off by %g at most\n", checks, worst_deviation_error);
+}
+
+/// ----------------------------------------------------------------------
+///                               histogram
+/// ----------------------------------------------------------------------
+
+// What was written to a tmpfile(), which it closes
+static std::string read_back(FILE *file)
+{
+	std::string text;
+	rewind(file);
+	char buffer[4096];
+	size_t size;
+	while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		text.append(buffer, size);
+	}
+	fclose(file);
+	return text;
+}
+
+// What Write makes of a histogram, which holds all of it
+static std::string write_histogram(const LatencyHistogram& histogram)
+{
+	FILE *file = tmpfile();
+	if (!file) {
+		return std::string();
+	}
+	histogram.Write(file);
+	return read_back(file);
+}
+
+static bool read_histogram(const std::string& text, LatencyHistogram& histogram)
+{
+	FILE *file = tmpfile();
+	if (!file) {
+		return false;
+	}
+	fwrite(text.data(), 1, text.size(), file);
+	rewind(file);
+	bool read = histogram.Read(file);
+	fclose(file);
+	return read;
+}
+
+static bool same_histogram(const LatencyHistogram& a, const LatencyHistogram& b)
+{
+	return a.GetCount() == b.GetCount() && write_histogram(a) == write_histogram(b);
+}
+
+// Percentiles of whole microseconds, which Record keeps as they are, against
+// the exact ones of the same samples: the rank of the percentile is rounded
+// the same way, and the value is off by at most 1/512 of it (half of a
+// bucket). Then merging halves, and writing and reading back, must give the
+// very same histogram, empty and with one sample too.
+static void test_histogram()
+{
+	static const double percents[] = { 0, 0.1, 1, 10, 25, 50, 75, 90, 99, 99.9, 99.99, 100 };
+
+	LatencyHistogram empty;
+	CHECK(empty.GetCount() == 0);
+	CHECK(empty.GetPercentile(50) == 0);
+
+	LatencyHistogram one;
+	one.Record(16.667);
+	size_t one_off = 0;
+	for (double percent : percents) {
+		one_off += fabs(one.GetPercentile(percent) - 16.667) > 16.667 / 512;
+	}
+	CHECK(one.GetCount() == 1);
+	CHECK(one_off == 0);
+
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<double> exponent(0, 8); // 1us to 100s
+	std::vector<UINT64> micros(200000);
+	for (auto& value : micros) {
+		value = UINT64(pow(10.0, exponent(rng)));
+	}
+
+	LatencyHistogram all, first, second;
+	for (size_t i = 0; i < micros.size(); ++i) {
+		all.Record(micros[i] / 1000.0);
+		(i < micros.size() / 2 ? first : second).Record(micros[i] / 1000.0);
+	}
+	CHECK(all.GetCount() == micros.size());
+
+	std::vector<UINT64> sorted = micros;
+	std::sort(sorted.begin(), sorted.end());
+	double results[sizeof(percents) / sizeof(percents[0])];
+	all.GetPercentiles(percents, UINT(sizeof(percents) / sizeof(percents[0])), results);
+	size_t off = 0;
+	for (size_t i = 0; i < sizeof(percents) / sizeof(percents[0]); ++i)
+	{
+		UINT64 rank = UINT64(percents[i] / 100 * sorted.size() + 0.5);
+		rank = std::min<UINT64>(std::max<UINT64>(rank, 1), sorted.size());
+		double exact = sorted[rank - 1] / 1000.0;
+		off += fabs(results[i] - exact) > exact / 512;
+		off += fabs(all.GetPercentile(percents[i]) - results[i]) != 0;
+	}
+	CHECK(off == 0);
+
+	LatencyHistogram merged;
+	merged.Merge(empty);
+	CHECK(same_histogram(merged, empty));
+	merged.Merge(first);
+	merged.Merge(second);
+	merged.Merge(empty);
+	CHECK(same_histogram(merged, all));
+
+	for (const LatencyHistogram *histogram : { &empty, &one, &all })
+	{
+		LatencyHistogram read;
+		CHECK(read_histogram(write_histogram(*histogram), read));
+		CHECK(same_histogram(read, *histogram));
+		CHECK(read.GetPercentile(99) == histogram->GetPercentile(99));
+	}
+
+	LatencyHistogram twice;
+	std::string text = write_histogram(one);
+	CHECK(read_histogram(text, twice) && read_histogram(text, twice));
+	CHECK(twice.GetCount() == 2);
+	CHECK(!read_histogram("# LatencyHistogram 3\n", twice));
+	printf("  %zu samples, p99 %.3fms\n", micros.size(), all.GetPercentile(99));
+}
+
+/// ----------------------------------------------------------------------
+///                                pacing
+/// ----------------------------------------------------------------------
+
+// Gives PresentQueueStats the frame statistics of a script
+struct scripted_swap_chain
+{
+	DXGI_FRAME_STATISTICS stats;
+	UINT last_present_count;
+
+	HRESULT GetFrameStatistics(DXGI_FRAME_STATISTICS *out)
+	{
+		if (!stats.PresentCount) {
+			return E_FAIL;
+		}
+		*out = stats;
+		return S_OK;
+	}
+
+	HRESULT GetLastPresentCount(UINT *out)
+	{
+		*out = last_present_count;
+		return S_OK;
+	}
+};
+
+// Seven presents at sync interval 1 on a 16ms refresh, through
+// PresentQueueStats into FramePacingAnalyzer, against records worked out by
+// hand. The third stays on screen for two refreshes (one missed), the fifth
+// is dropped, and the statistics that show the seventh are read a refresh
+// late, so its display time has to be worked back from the refresh period.
+static void test_pacing()
+{
+	const UINT64 period = 160000; // 16ms in 100ns ticks
+	struct step
+	{
+		UINT64 time;
+		UINT present_id; // posts this present at time, its call 2000 ticks earlier
+		DXGI_FRAME_STATISTICS stats; // or else retrieves these
+	};
+	// The statistics read at vsync sync_refresh, the last present shown
+	// being present_id, at vsync present_refresh
+	auto shown = [&](UINT present_id, UINT present_refresh, UINT sync_refresh) {
+		DXGI_FRAME_STATISTICS stats = {};
+		stats.PresentCount = present_id;
+		stats.PresentRefreshCount = present_refresh;
+		stats.SyncRefreshCount = sync_refresh;
+		stats.SyncQPCTime.QuadPart = INT64(sync_refresh * period);
+		return stats;
+	};
+	const step script[] = {
+		{ 10 * period + 3000, 1, {} },
+		{ 10 * period + 22000, 2, {} },
+		{ 11 * period, 0, shown(1, 11, 11) },
+		{ 11 * period + 7000, 3, {} },
+		{ 12 * period, 0, shown(2, 12, 12) },
+		{ 12 * period + 7000, 4, {} },
+		{ 13 * period, 0, shown(3, 13, 13) },
+		{ 13 * period + 7000, 5, {} },
+		{ 13 * period + 52000, 6, {} },
+		{ 15 * period, 0, shown(4, 15, 15) },
+		{ 15 * period + 7000, 7, {} },
+		{ 16 * period, 0, shown(6, 16, 16) },
+		{ 18 * period, 0, shown(7, 17, 18) },
+	};
+
+	PresentQueueStats<> queue;
+	FramePacingAnalyzer analyzer;
+	scripted_swap_chain chain = {};
+	FILE *csv = tmpfile();
+	if (!csv) {
+		CHECK(csv);
+		return;
+	}
+	const PresentMonCsvInfo info = { "test", 1234, 0xDEADBEEF, "Hardware: Independent Flip" };
+	WritePresentMonCsvHeader(csv);
+	auto write_row = [&](const FramePacingRecord& record) {
+		WritePresentMonCsvRow(csv, info, record);
+	};
+	size_t dequeued = 0;
+	for (auto& s : script)
+	{
+		if (s.present_id) {
+			chain.last_present_count = s.present_id;
+			queue.PostPresent(&chain, 1, s.time - 10000, s.present_id, s.time, s.time - 2000);
+			continue;
+		}
+		chain.stats = s.stats;
+		queue.RetrieveStats(&chain, [&](const PresentQueueStats<>::QueueEntry& entry) {
+			++dequeued;
+			analyzer.AddPresent(entry, write_row);
+		});
+	}
+	analyzer.Flush(write_row);
+
+	auto& totals = analyzer.GetTotals();
+	CHECK(dequeued == 7);
+	CHECK(totals.Presents == 7);
+	CHECK(totals.Displayed == 6);
+	CHECK(totals.Dropped == 1);
+	CHECK(totals.MissedRefreshes == 1);
+	CHECK(totals.QueueDepthSum == 1 + 2 + 2 + 2 + 2 + 3 + 3);
+	CHECK(totals.MaxQueueDepth == 3);
+
+	const char *rows[] = {
+		"Application,ProcessID,SwapChainAddress,Runtime,SyncInterval,PresentFlags,AllowsTearing,PresentMode,"
+			"Dropped,TimeInSeconds,MsBetweenPresents,MsBetweenDisplayChange,MsInPresentAPI,MsUntilRenderComplete,MsUntilDisplayed,"
+			"MsDisplayed,RefreshesDisplayed,MissedRefreshes,QueueDepth",
+		"test,1234,0x00000000DEADBEEF,DXGI,1,0,0,Hardware: Independent Flip,0,0.000000,0.000,0.000,0.200,0.000,15.900,16.000,1,0,1",
+		"test,1234,0x00000000DEADBEEF,DXGI,1,0,0,Hardware: Independent Flip,0,0.001900,1.900,16.000,0.200,0.000,30.000,16.000,1,0,2",
+		"test,1234,0x00000000DEADBEEF,DXGI,1,0,0,Hardware: Independent Flip,0,0.016400,14.500,16.000,0.200,0.000,31.500,32.000,2,1,2",
+		"test,1234,0x00000000DEADBEEF,DXGI,1,0,0,Hardware: Independent Flip,0,0.032400,16.000,32.000,0.200,0.000,47.500,16.000,1,0,2",
+		"test,1234,0x00000000DEADBEEF,DXGI,1,0,0,Hardware: Independent Flip,1,0.048400,16.000,0.000,0.200,0.000,0.000,0.000,0,0,2",
+		"test,1234,0x00000000DEADBEEF,DXGI,1,0,0,Hardware: Independent Flip,0,0.052900,4.500,16.000,0.200,0.000,43.000,16.000,1,0,3",
+		"test,1234,0x00000000DEADBEEF,DXGI,1,0,0,Hardware: Independent Flip,0,0.080400,27.500,16.000,0.200,0.000,31.500,0.000,0,0,3",
+	};
+	std::string expected;
+	for (auto row : rows) {
+		expected += row;
+		expected += '\n';
+	}
+	std::string written = read_back(csv);
+	CHECK(written == expected);
+	if (written != expected) {
+		printf("%s", written.c_str());
+	}
+}
+
+/// ----------------------------------------------------------------------
+
+struct test
+{
+	const char *name;
+	void (*run)();
+};
+
+static const test tests[] = {
+	{ "recorders", test_recorders },
+	{ "window", test_window },
+	{ "steady", test_steady },
+	{ "stacks", test_stacks },
+	{ "lod", test_lod },
+	{ "worker", test_worker },
+	{ "vertices", test_vertices },
+	{ "instances", test_instances },
+	{ "latency", test_latency },
+	{ "histogram", test_histogram },
+	{ "pacing", test_pacing },
+};
+
+int main(int argc, char **argv)
+{
+	std::vector<const test*> selected;
+	for (int i = 1; i < argc; ++i)
+	{
+		const test *found = nullptr;
+		for (auto& t : tests) {
+			if (!strcmp(argv[i], t.name)) {
+				found = &t;
+			}
+		}
+		if (!found) {
+			printf("usage: eviz_test [test...]\ntests:");
+			for (auto& t : tests) {
+				printf(" %s", t.name);
+			}
+			printf("\n");
+			return 1;
+		}
+		selected.push_back(found);
+	}
+	if (selected.empty()) {
+		for (auto& t : tests) {
+			selected.push_back(&t);
+		}
+	}
+
+	for (auto t : selected) {
+		int before = failures;
+		printf("%s\n", t->name);
+		t->run();
+		printf("  %s\n", failures == before ? "ok" : "FAILED");
+	}
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,406 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#include "flip_model_sim.hpp"
+#include "eviz_vertices.hpp"
+
+#include <algorithm>
+
+enum : UINT64 {
+	kBusy = ~0ULL, // a time that has not happened yet
+};
+
+enum : UINT {
+	kDefaultMaxFrameLatency = 3, // DXGI's, for swap chains without the waitable object
+	kStallVsyncs = 10000, // a wait this long means nothing will ever change
+};
+
+// The sample's event types (event_types in sample_dx12.cpp)
+static eventviz_aux event_types[] = {
+	{"present call", 0x9A, 0x2E, 0xFE, 0xFF},
+	{"swapchain wait", 0xFF, 0xFF, 0x00, 0xFF},
+	{"frame wait", 0x00, 0x00, 0xFF, 0xFF},
+	{"color_0", 0xff, 0x6B, 0x6C, 0xFF},
+	{"color_1", 0x18, 0xC7, 0xFC, 0xFF},
+	{"color_2", 0xF3, 0xAB, 0x00, 0xFF},
+	{"color_3", 0xB3, 0xB1, 0xFF, 0xFF},
+	{"color_4", 0x00, 0xD1, 0xA5, 0xFF},
+	{"color_5", 0xAB, 0xC4, 0x00, 0xFF},
+	{"color_6", 0xFF, 0x93, 0xEE, 0xFF},
+	{"color_7", 0x29, 0xD4, 0x22, 0xFF},
+};
+
+enum {
+	EVENT_TYPE_PRESENT_CALL,
+	EVENT_TYPE_SWAPCHAIN_WAIT,
+	EVENT_TYPE_FRAME_WAIT,
+	EVENT_TYPE_COLOR0,
+	NUM_FRAME_COLORS = 8,
+};
+
+HRESULT simulated_swap_chain::GetFrameStatistics(DXGI_FRAME_STATISTICS *pStats)
+{
+	if (!stats.PresentCount) {
+		return E_FAIL; // DXGI_ERROR_FRAME_STATISTICS_DISJOINT
+	}
+	*pStats = stats;
+	return S_OK;
+}
+
+HRESULT simulated_swap_chain::GetLastPresentCount(UINT *pLastPresentCount)
+{
+	*pLastPresentCount = last_present_count;
+	return S_OK;
+}
+
+flip_model_sim::flip_model_sim(const flip_model_config& config, const flip_model_workload& workload,
+	EventViz::EventStream *eviz)
+	: pacing_csv(nullptr), config(config), workload(workload), eviz(eviz), rng(workload.seed)
+{
+	// what the sample and DXGI accept
+	this->config.swapchain_buffer_count = std::min(std::max(this->config.swapchain_buffer_count, 2), 16);
+	this->config.max_frame_latency = std::max(this->config.max_frame_latency, 1);
+	this->config.gpu_frame_count = std::max(this->config.gpu_frame_count, 1);
+	this->config.sync_interval = std::min(std::max(this->config.sync_interval, 0), 4);
+	assert(config.refresh_hz > 0);
+	if (this->workload.cpu_ms.empty()) this->workload.cpu_ms.push_back(0);
+	if (this->workload.gpu_ms.empty()) this->workload.gpu_ms.push_back(0);
+
+	memset(&swap_chain, 0, sizeof(swap_chain));
+
+	// EventStream takes a time of 0 to mean now, so start later than that
+	start_time = SecondsToQpcTime(1);
+	cpu_time = start_time;
+	gpu_idle_time = start_time;
+	vsync_interval = SecondsToQpcTime(1 / config.refresh_hz);
+	next_vsync = start_time + vsync_interval;
+	vsync_count = 0;
+
+	next_id = 1;
+	next_gpu_id = 1;
+	presented_count = 0;
+	contexts.assign(this->config.gpu_frame_count, frame_context());
+	buffer_free_time.assign(this->config.swapchain_buffer_count, start_time);
+	on_screen_buffer = UINT(-1);
+	on_screen_until = 0;
+
+	displayed = dropped = 0;
+	latency_sum = 0;
+	measured_count = measured_dropped = jitter_count = 0;
+	measured_latency_sum = stddev_jitter_sum = minmax_jitter_sum = 0;
+	swapchain_wait = frame_wait = present_wait = 0;
+	stalls = 0;
+}
+
+UINT64 flip_model_sim::sample_ms(const std::vector<double>& samples)
+{
+	double ms = samples.size() == 1 ? samples[0] : samples[rng() % samples.size()];
+	return SecondsToQpcTime(std::max(ms, 0.0) / 1000);
+}
+
+UINT64 flip_model_sim::get_queued_count() const
+{
+	return presented_count - (frames.empty() ? next_id - 1 : frames.front().id - 1);
+}
+
+void flip_model_sim::advance(UINT64 duration)
+{
+	cpu_time += duration;
+	process_vsyncs(cpu_time);
+}
+
+void flip_model_sim::process_vsyncs(UINT64 until)
+{
+	while (next_vsync <= until) {
+		process_vsync(next_vsync);
+		next_vsync += vsync_interval;
+	}
+}
+
+void flip_model_sim::process_vsync(UINT64 time)
+{
+	++vsync_count;
+	if (on_screen_buffer != UINT(-1) && time < on_screen_until) {
+		return;
+	}
+
+	// Presents are shown in order; with sync interval 0 the newest one that
+	// is ready replaces the ones before it.
+	size_t ready = 0;
+	while (ready < frames.size() &&
+		frames[ready].presented <= time &&
+		frames[ready].gpu_done <= time)
+	{
+		++ready;
+		if (config.sync_interval) {
+			break;
+		}
+	}
+	if (!ready) {
+		return;
+	}
+
+	for (size_t i = 0; i + 1 < ready; ++i) {
+		buffer_free_time[frames.front().buffer] = time;
+		frames.pop_front();
+		++dropped;
+	}
+
+	auto& shown = frames.front();
+	if (on_screen_buffer != UINT(-1)) {
+		buffer_free_time[on_screen_buffer] = time;
+	}
+	on_screen_buffer = shown.buffer;
+	on_screen_until = time + std::max(config.sync_interval, 1) * vsync_interval;
+
+	++displayed;
+	latency_sum += 1000 * QpcTimeToSeconds(time - shown.frame_begin);
+
+	swap_chain.stats.PresentCount = UINT(shown.id);
+	swap_chain.stats.PresentRefreshCount = vsync_count;
+	swap_chain.stats.SyncRefreshCount = vsync_count;
+	swap_chain.stats.SyncQPCTime.QuadPart = INT64(time);
+	swap_chain.stats.SyncGPUTime.QuadPart = INT64(time);
+
+	frames.pop_front();
+	schedule_gpu(); // buffers were released
+}
+
+// The GPU runs frames in order; each one starts once it was submitted, the
+// one before it is done, and its back buffer is free.
+void flip_model_sim::schedule_gpu()
+{
+	while (next_gpu_id < next_id)
+	{
+		auto& frame = get_frame(next_gpu_id);
+		UINT64 free_time = buffer_free_time[frame.buffer];
+		if (free_time == kBusy) {
+			return; // until a vsync releases it
+		}
+
+		frame.gpu_start = std::max(std::max(frame.submit, gpu_idle_time), free_time);
+		frame.gpu_done = frame.gpu_start + frame.gpu_duration;
+		gpu_idle_time = frame.gpu_done;
+		buffer_free_time[frame.buffer] = kBusy;
+
+		auto& context = contexts[size_t((frame.id - 1) % contexts.size())];
+		context.gpu_start = frame.gpu_start;
+		context.gpu_done = frame.gpu_done;
+
+		++next_gpu_id;
+	}
+}
+
+// Blocks the CPU until ready(), which only changes at vsyncs.
+template<class Ready>
+void flip_model_sim::wait_until(Ready ready)
+{
+	for (UINT vsyncs = 0; !ready(); ++vsyncs)
+	{
+		if (vsyncs == kStallVsyncs) {
+			++stalls;
+			return;
+		}
+		cpu_time = std::max(cpu_time, next_vsync);
+		process_vsyncs(cpu_time);
+	}
+}
+
+void flip_model_sim::wait_for_gpu(const frame_context& context)
+{
+	if (!context.id) {
+		return;
+	}
+	wait_until([&] { return context.id < next_gpu_id; });
+	if (context.id < next_gpu_id && context.gpu_done > cpu_time) {
+		advance(context.gpu_done - cpu_time);
+	}
+}
+
+// As dequeue_presents in sample_dx12.cpp
+void flip_model_sim::dequeue_presents()
+{
+	double latency = 0;
+
+	auto dequeue_entry = [&](PresentQueueStats<>::QueueEntry& e) {
+		if (eviz) {
+			eviz->End(e.UserData, e.QueueExitedTime);
+		}
+		if (!e.Dropped) {
+			if (eviz) {
+				eviz->Vsync(e.QueueExitedTime);
+			}
+			double real_latency = 1000 * QpcTimeToSeconds(e.QueueExitedTime - e.FrameBeginTime);
+			if (real_latency)
+			{
+				latency_stats.Sample(real_latency, e.QueueExitedTime);
+				latency_histogram.Record(real_latency);
+				latency = real_latency;
+				measured_latency_sum += real_latency;
+				++measured_count;
+			}
+		} else {
+			++measured_dropped;
+		}
+		pacing.AddPresent(e, [this](const FramePacingRecord& record) { write_pacing_record(record); });
+	};
+
+	pqs.RetrieveStats(&swap_chain, dequeue_entry);
+
+	if (latency)
+	{
+		stddev_jitter_sum += latency_stats.EvaluateStdDevMetric();
+		minmax_jitter_sum += latency_stats.EvaluateMinMaxMetric();
+		++jitter_count;
+	}
+}
+
+void flip_model_sim::write_pacing_record(const FramePacingRecord& record)
+{
+	if (pacing_csv) {
+		PresentMonCsvInfo info = { "flip_sim", 0, UINT64(&swap_chain), "Hardware: Independent Flip" };
+		WritePresentMonCsvRow(pacing_csv, info, record);
+	}
+}
+
+void flip_model_sim::flush_pacing()
+{
+	pacing.Flush([this](const FramePacingRecord& record) { write_pacing_record(record); });
+}
+
+void flip_model_sim::run_frame()
+{
+	if (config.use_waitable_object)
+	{
+		UINT64 start = cpu_time;
+		wait_until([&] { return get_queued_count() < UINT64(config.max_frame_latency); });
+		swapchain_wait += cpu_time - start;
+		if (eviz) {
+			eviz->InsertEvent(EventViz::kCpuQueue, start, cpu_time, &event_types[EVENT_TYPE_SWAPCHAIN_WAIT]);
+		}
+	}
+
+	if (eviz) {
+		eviz->TrimToLastNVsyncs(256);
+	}
+
+	UINT64 id = next_id;
+	auto& context = contexts[size_t((id - 1) % contexts.size())];
+	{
+		UINT64 start = cpu_time;
+		wait_for_gpu(context);
+		frame_wait += cpu_time - start;
+		if (eviz) {
+			eviz->InsertEvent(EventViz::kCpuQueue, start, cpu_time, &event_types[EVENT_TYPE_FRAME_WAIT]);
+		}
+	}
+
+	// The GPU event of the frame that used this context before
+	if (eviz && context.id) {
+		UINT color_index = UINT((context.id - 1) % config.swapchain_buffer_count) % NUM_FRAME_COLORS;
+		eviz->InsertEvent(EventViz::kGpuQueue, context.gpu_start, context.gpu_done,
+			&event_types[EVENT_TYPE_COLOR0 + color_index], context.id);
+	}
+
+	UINT64 frame_begin = cpu_time;
+	dequeue_presents();
+
+	frame_record frame = {};
+	frame.id = id;
+	frame.frame_begin = frame_begin;
+	frame.buffer = UINT((id - 1) % config.swapchain_buffer_count); // flip-discard hands them out in turn
+	frame.gpu_duration = sample_ms(workload.gpu_ms);
+	frame.gpu_start = frame.gpu_done = kBusy;
+	frame.presented = kBusy;
+	context.id = id;
+
+	UINT color_index = frame.buffer % NUM_FRAME_COLORS;
+	{
+		UINT64 start = cpu_time;
+		advance(sample_ms(workload.cpu_ms));
+		if (eviz) {
+			eviz->InsertEvent(EventViz::kCpuQueue, start, cpu_time, &event_types[EVENT_TYPE_COLOR0 + color_index], id);
+		}
+	}
+
+	frame.submit = cpu_time;
+	frames.push_back(frame);
+	++next_id;
+	schedule_gpu();
+
+	UINT64 present_call_time = cpu_time;
+	{
+		UINT64 start = cpu_time;
+		if (!config.use_waitable_object) {
+			wait_until([&] { return get_queued_count() < kDefaultMaxFrameLatency; });
+			present_wait += cpu_time - start;
+		}
+		advance(SecondsToQpcTime(config.present_call_ms / 1000));
+		if (eviz) {
+			eviz->InsertEvent(EventViz::kCpuQueue, start, cpu_time, &event_types[EVENT_TYPE_PRESENT_CALL]);
+		}
+	}
+
+	get_frame(id).presented = cpu_time;
+	++presented_count;
+	swap_chain.last_present_count = UINT(id);
+
+	auto present_entry = eviz ? eviz->Start(EventViz::kPresentQueue, &event_types[EVENT_TYPE_COLOR0 + color_index], id, cpu_time) : 0;
+	pqs.PostPresent(&swap_chain, config.sync_interval, frame_begin, present_entry, cpu_time, present_call_time);
+
+	dequeue_presents();
+}
+
+void flip_model_sim::run(double seconds)
+{
+	UINT64 end_time = cpu_time + SecondsToQpcTime(seconds);
+	while (cpu_time < end_time) {
+		run_frame();
+	}
+}
+
+flip_model_results flip_model_sim::get_results() const
+{
+	flip_model_results results = {};
+	results.seconds = QpcTimeToSeconds(cpu_time - start_time);
+	results.frames = presented_count;
+	results.displayed = displayed;
+	results.dropped = dropped;
+	results.stalls = stalls;
+
+	auto per = [](double total, UINT64 count) { return count ? total / count : 0; };
+	auto ms = [](UINT64 ticks) { return 1000 * QpcTimeToSeconds(ticks); };
+
+	double seconds = std::max(results.seconds, 1e-9);
+	results.fps = presented_count / seconds;
+	results.displayed_fps = displayed / seconds;
+	results.dropped_rate = per(double(dropped), displayed + dropped);
+	results.avg_latency_ms = per(latency_sum, displayed);
+
+	results.measured_latency_ms = per(measured_latency_sum, measured_count);
+	results.measured_dropped_rate = per(double(measured_dropped), measured_count + measured_dropped);
+	results.stddev_jitter_ms = per(stddev_jitter_sum, jitter_count);
+	results.minmax_jitter_ms = per(minmax_jitter_sum, jitter_count);
+
+	auto& totals = pacing.GetTotals();
+	results.missed_refreshes = totals.MissedRefreshes;
+	results.avg_queue_depth = per(double(totals.QueueDepthSum), totals.Presents);
+	results.max_queue_depth = totals.MaxQueueDepth;
+
+	results.swapchain_wait_ms = per(ms(swapchain_wait), presented_count);
+	results.frame_wait_ms = per(ms(frame_wait), presented_count);
+	results.present_wait_ms = per(ms(present_wait), presented_count);
+	return results;
+}
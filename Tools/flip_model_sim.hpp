@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WindowsHelpers.hpp"
+#include "PresentQueueStats.hpp"
+#include "LatencyHistogram.hpp"
+#include "FramePacing.hpp"
+#include "EventViz.hpp"
+
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <vector>
+
+// flip_model_sim: a deterministic discrete-event model of the sample's frame
+// loop (render_game_dx12) on a DXGI flip-discard swap chain, on a virtual
+// clock. It computes the latency and dropped frames of any configuration
+// without a GPU, and feeds PresentQueueStats, LatencyStatistics,
+// LatencyHistogram, FramePacingAnalyzer and an EventViz::EventStream the way
+// the sample does.
+//
+// The model, per frame:
+// - with use_waitable_object, wait until fewer than max_frame_latency
+//   presents are waiting to be shown (the frame latency waitable object);
+// - wait for the GPU to finish the frame that last used this one of the
+//   gpu_frame_count frame contexts (FrameQueue::BeginFrame);
+// - spend the CPU time of the frame and submit its GPU work, which renders
+//   to the next back buffer in turn and so waits until that buffer has left
+//   the screen or been dropped;
+// - Present(), which without the waitable object blocks while 3 presents
+//   are waiting to be shown (DXGI's default maximum frame latency; the
+//   sample only sets max_frame_latency on waitable swap chains).
+// At each vsync the oldest present whose GPU work is done is shown, after the
+// current one has been up for sync_interval vsyncs. With sync interval 0 the
+// newest finished present is shown instead, and the ones before it dropped.
+
+struct flip_model_config
+{
+	// as in dx12_swapchain_options::create_time
+	int use_waitable_object;
+	int max_frame_latency;
+	int swapchain_buffer_count;
+	int gpu_frame_count;
+
+	int sync_interval; // 0 to 4, as passed to Present()
+	double refresh_hz;
+	double present_call_ms; // CPU time spent in Present() when it does not block
+};
+
+// CPU and GPU time per frame, drawn at random from measured samples.
+// One sample makes it constant.
+struct flip_model_workload
+{
+	std::vector<double> cpu_ms;
+	std::vector<double> gpu_ms;
+	unsigned seed;
+};
+
+// The stats source PresentQueueStats reads, as from IDXGISwapChain1.
+struct simulated_swap_chain
+{
+	HRESULT GetFrameStatistics(DXGI_FRAME_STATISTICS *pStats); // fails until something was shown
+	HRESULT GetLastPresentCount(UINT *pLastPresentCount);
+
+private:
+	friend struct flip_model_sim;
+	DXGI_FRAME_STATISTICS stats;
+	UINT last_present_count;
+};
+
+struct flip_model_results
+{
+	double seconds; // simulated
+	UINT64 frames; // presented
+	UINT64 displayed, dropped; // by the model; the rest are still queued
+	double fps; // presents per second
+	double displayed_fps;
+	double dropped_rate; // dropped / (displayed + dropped)
+	double avg_latency_ms; // from frame begin to the vsync that shows it, over all shown frames
+
+	// what the sample would measure and show in its HUD
+	double measured_latency_ms; // average over the samples of PresentQueueStats
+	double measured_dropped_rate; // presents PresentQueueStats reported dropped
+	double stddev_jitter_ms; // EvaluateStdDevMetric after each sample, averaged
+	double minmax_jitter_ms; // EvaluateMinMaxMetric after each sample, averaged
+	UINT64 missed_refreshes; // from FramePacingAnalyzer
+	double avg_queue_depth;
+	UINT max_queue_depth;
+
+	double swapchain_wait_ms; // per frame, blocked on the waitable object
+	double frame_wait_ms; // per frame, blocked in FrameQueue::BeginFrame
+	double present_wait_ms; // per frame, blocked in Present()
+	UINT64 stalls; // waits that never ended; the configuration deadlocks
+};
+
+struct flip_model_sim
+{
+	// eviz, if any, gets the sample's CPU, GPU, Present and Vsync events
+	flip_model_sim(const flip_model_config& config, const flip_model_workload& workload,
+		EventViz::EventStream *eviz = nullptr);
+
+	void run_frame();
+	void run(double seconds); // frames until the virtual clock has advanced that much
+
+	flip_model_results get_results() const;
+	const flip_model_config& get_config() const { return config; }
+	UINT64 now() const { return cpu_time; }
+
+	// what the sample keeps in dx12_data
+	PresentQueueStats<> pqs;
+	LatencyStatistics latency_stats;
+	LatencyHistogram latency_histogram;
+	FramePacingAnalyzer pacing;
+
+	// if set, gets a PresentMon CSV row per present (see FramePacing.hpp);
+	// call flush_pacing() at the end for the last ones
+	FILE *pacing_csv;
+	void flush_pacing();
+
+private:
+
+	struct frame_record
+	{
+		UINT64 id; // the present count after its Present()
+		UINT64 frame_begin; // CpuFrameStart
+		UINT64 submit, gpu_duration, gpu_start, gpu_done;
+		UINT64 presented; // when it entered the present queue
+		UINT buffer; // back buffer index
+	};
+
+	struct frame_context
+	{
+		UINT64 id; // the last frame rendered with it, 0 for none
+		UINT64 gpu_start, gpu_done;
+	};
+
+	frame_record& get_frame(UINT64 id) { return frames[size_t(id - frames.front().id)]; }
+	UINT64 get_queued_count() const; // presented, neither shown nor dropped
+
+	void advance(UINT64 duration);
+	void process_vsyncs(UINT64 until);
+	void process_vsync(UINT64 time);
+	void schedule_gpu();
+	template<class Ready> void wait_until(Ready ready);
+	void wait_for_gpu(const frame_context& context);
+	void dequeue_presents();
+	void write_pacing_record(const FramePacingRecord& record);
+	UINT64 sample_ms(const std::vector<double>& samples);
+
+	flip_model_config config;
+	flip_model_workload workload;
+	EventViz::EventStream *eviz;
+	std::mt19937 rng;
+	simulated_swap_chain swap_chain;
+
+	UINT64 start_time;
+	UINT64 cpu_time;
+	UINT64 gpu_idle_time; // when the GPU finishes the work scheduled so far
+	UINT64 vsync_interval;
+	UINT64 next_vsync;
+	UINT vsync_count;
+
+	std::deque<frame_record> frames; // not yet shown or dropped, by id
+	UINT64 next_id; // of the next frame
+	UINT64 next_gpu_id; // the first frame whose GPU work is not scheduled
+	UINT64 presented_count;
+	std::vector<frame_context> contexts; // gpu_frame_count of them
+	std::vector<UINT64> buffer_free_time; // kBusy while rendered to, queued or on screen
+	UINT on_screen_buffer;
+	UINT64 on_screen_until; // the first vsync it can be replaced at
+
+	UINT64 displayed, dropped;
+	double latency_sum;
+	UINT64 measured_count, measured_dropped, jitter_count;
+	double measured_latency_sum, stddev_jitter_sum, minmax_jitter_sum;
+	UINT64 swapchain_wait, frame_wait, present_wait;
+	UINT64 stalls;
+};
@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#include "flip_model_tuner.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+static const double kFpsTolerance = 0.02; // shown frame rate, relative to the best
+static const double kDroppedTolerance = 0.01; // dropped frame rate, absolute
+static const double kLatencyTieMs = 1; // closer latencies than this are ranked by jitter instead
+static const double kJitterTieMs = 0.5; // closer jitter than this is ranked by memory use instead
+
+static int get_memory_use(const flip_model_config& config)
+{
+	return config.swapchain_buffer_count + config.gpu_frame_count;
+}
+
+// Of configurations that do exactly as well, the one using the least memory
+// dominates the others, so that the front lists each outcome once.
+static bool dominates(const flip_model_candidate& a, const flip_model_candidate& b)
+{
+	double as[] = { a.results.avg_latency_ms, a.jitter_ms, a.results.dropped_rate, -a.results.displayed_fps };
+	double bs[] = { b.results.avg_latency_ms, b.jitter_ms, b.results.dropped_rate, -b.results.displayed_fps };
+
+	bool better = false;
+	for (int i = 0; i < 4; ++i) {
+		if (as[i] > bs[i]) {
+			return false;
+		}
+		better = better || as[i] < bs[i];
+	}
+	return better || get_memory_use(a.config) < get_memory_use(b.config) ||
+		(get_memory_use(a.config) == get_memory_use(b.config) && &a < &b);
+}
+
+std::vector<flip_model_candidate> tune_flip_model(const flip_model_tuning_options& options,
+	const flip_model_workload& workload)
+{
+	std::vector<flip_model_candidate> candidates;
+
+	for (int waitable = 0; waitable <= 1; ++waitable)
+	for (int latency = 1; latency <= (waitable ? options.max_frame_latency : 1); ++latency)
+	for (int buffers = 2; buffers <= options.max_buffer_count; ++buffers)
+	for (int gpu_frames = 1; gpu_frames <= options.max_gpu_frame_count; ++gpu_frames)
+	{
+		flip_model_candidate candidate = {};
+		candidate.config.use_waitable_object = waitable;
+		candidate.config.max_frame_latency = latency;
+		candidate.config.swapchain_buffer_count = buffers;
+		candidate.config.gpu_frame_count = gpu_frames;
+		candidate.config.sync_interval = options.sync_interval;
+		candidate.config.refresh_hz = options.refresh_hz;
+		candidate.config.present_call_ms = options.present_call_ms;
+
+		flip_model_sim sim(candidate.config, workload);
+		sim.run(options.seconds);
+		candidate.results = sim.get_results();
+		candidate.jitter_ms = options.minmax_jitter ? candidate.results.minmax_jitter_ms : candidate.results.stddev_jitter_ms;
+		if (candidate.results.stalls) {
+			continue; // deadlocks; not an option
+		}
+		candidates.push_back(candidate);
+	}
+
+	for (auto& candidate : candidates) {
+		candidate.pareto = std::none_of(candidates.begin(), candidates.end(),
+			[&](const flip_model_candidate& other) { return &other != &candidate && dominates(other, candidate); });
+	}
+	return candidates;
+}
+
+size_t recommend_flip_model(const std::vector<flip_model_candidate>& candidates)
+{
+	double best_fps = 0, best_dropped = 1;
+	for (auto& c : candidates) {
+		best_fps = std::max(best_fps, c.results.displayed_fps);
+		best_dropped = std::min(best_dropped, c.results.dropped_rate);
+	}
+
+	auto acceptable = [&](const flip_model_candidate& c) {
+		return c.pareto &&
+			c.results.displayed_fps >= best_fps * (1 - kFpsTolerance) &&
+			c.results.dropped_rate <= best_dropped + kDroppedTolerance;
+	};
+
+	double best_latency = HUGE_VAL;
+	for (auto& c : candidates) {
+		if (acceptable(c)) {
+			best_latency = std::min(best_latency, c.results.avg_latency_ms);
+		}
+	}
+
+	auto low_latency = [&](const flip_model_candidate& c) {
+		return acceptable(c) && c.results.avg_latency_ms <= best_latency + kLatencyTieMs;
+	};
+
+	double best_jitter = HUGE_VAL;
+	for (auto& c : candidates) {
+		if (low_latency(c)) {
+			best_jitter = std::min(best_jitter, c.jitter_ms);
+		}
+	}
+
+	size_t best = candidates.size();
+	for (size_t i = 0; i < candidates.size(); ++i)
+	{
+		auto& c = candidates[i];
+		if (!low_latency(c) || c.jitter_ms > best_jitter + kJitterTieMs) {
+			continue;
+		}
+		if (best == candidates.size() ||
+			get_memory_use(c.config) < get_memory_use(candidates[best].config) ||
+			(get_memory_use(c.config) == get_memory_use(candidates[best].config) &&
+				c.results.avg_latency_ms < candidates[best].results.avg_latency_ms)) {
+			best = i;
+		}
+	}
+	return best;
+}
+
+dx12_swapchain_options get_swapchain_options(const flip_model_config& config)
+{
+	dx12_swapchain_options options = {};
+	options.create_time.use_waitable_object = config.use_waitable_object;
+	options.create_time.max_frame_latency = config.max_frame_latency;
+	options.create_time.swapchain_buffer_count = config.swapchain_buffer_count;
+	options.create_time.gpu_frame_count = config.gpu_frame_count;
+	return options;
+}
@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "flip_model_sim.hpp"
+#include "sample_dx12.hpp"
+
+#include <vector>
+
+// Searches the sample's swap chain options (what process_inputs lets you
+// toggle) in flip_model_sim, for a given workload and display, instead of
+// by hand with the HUD.
+
+struct flip_model_tuning_options
+{
+	int sync_interval;
+	double refresh_hz;
+	double present_call_ms;
+	double seconds; // simulated per configuration
+
+	// the ranges searched; process_inputs allows up to 8 of each
+	int max_frame_latency;
+	int max_buffer_count;
+	int max_gpu_frame_count;
+
+	bool minmax_jitter; // rank by EvaluateMinMaxMetric instead of EvaluateStdDevMetric
+};
+
+struct flip_model_candidate
+{
+	flip_model_config config;
+	flip_model_results results;
+	double jitter_ms; // the metric picked in flip_model_tuning_options
+	bool pareto; // no other candidate is as good in every way and better in one, or uses less memory
+};
+
+// Simulates every configuration in the ranges and marks the Pareto front of
+// average latency, jitter, dropped frame rate and shown frame rate. Without
+// the waitable object max_frame_latency has no effect, so only 1 is tried.
+std::vector<flip_model_candidate> tune_flip_model(const flip_model_tuning_options& options,
+	const flip_model_workload& workload);
+
+// The candidate to use: of the ones on the front that show about as many
+// frames and drop about as few as the best, the ones with about the lowest
+// latency; of those, the ones with about the lowest jitter; of those, the
+// one with the fewest buffers and GPU frames. Returns candidates.size() if
+// there are none.
+size_t recommend_flip_model(const std::vector<flip_model_candidate>& candidates);
+
+dx12_swapchain_options get_swapchain_options(const flip_model_config& config);
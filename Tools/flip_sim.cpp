@@ -0,0 +1,365 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+// flip_sim: runs one swap chain configuration of the sample through
+// flip_model_sim and prints what it would measure, or with --tune, finds
+// the configurations worth using for a workload (see flip_model_tuner.hpp).
+//
+// Build from the repository root, on any platform:
+//   g++ -std=c++14 -O2 -ISource Tools/flip_sim.cpp Tools/flip_model_sim.cpp Tools/flip_model_tuner.cpp Source/EventViz.cpp -lpthread -o flip_sim
+//
+// Frame times can be measured ones, from a file of milliseconds:
+//   ./flip_sim --tune --cpu-ms @cpu_ms.txt --gpu-ms @gpu_ms.txt --refresh 144
+//
+// --write-trace saves the simulated EventViz events in the format eviz_cli
+// reads, to look at the timeline of a configuration:
+//   ./flip_sim --buffers 2 --sync 1 --cpu-ms 12 --gpu-ms 20 --seconds 2 --write-trace sim.csv
+//   ./eviz_cli sim.csv --svg sim.svg
+//
+// --histogram adds the measured latencies to a LatencyHistogram file, so that
+// the percentiles of several runs (seeds, workloads) can be read together:
+//   ./flip_sim --seed 1 --histogram latency.txt
+//   ./flip_sim --seed 2 --histogram latency.txt
+//
+// --pacing-csv logs every present as PresentMon would, with the frame
+// pacing columns of FramePacingAnalyzer after its own.
+
+#include "flip_model_sim.hpp"
+#include "flip_model_tuner.hpp"
+#include "eviz_vertices.hpp"
+#include "tool_main.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// "8" or "7.5,8,12" (samples drawn at random), or "@file" for a file of
+// them, separated by commas or white space; # starts a comment.
+static std::vector<double> parse_samples(const char *text)
+{
+	std::vector<double> samples;
+	if (text[0] == '@')
+	{
+		FILE *file = fopen(text + 1, "r");
+		if (!file) {
+			fprintf(stderr, "cannot open %s\n", text + 1);
+			return samples;
+		}
+		char line[1024];
+		while (fgets(line, sizeof(line), file))
+		{
+			line[strcspn(line, "#")] = 0;
+			for (char *c = strtok(line, ", \t\r\n"); c; c = strtok(nullptr, ", \t\r\n")) {
+				samples.push_back(atof(c));
+			}
+		}
+		fclose(file);
+		return samples;
+	}
+
+	for (const char *c = text; *c; ) {
+		char *end;
+		samples.push_back(strtod(c, &end));
+		if (end == c) {
+			break;
+		}
+		c = *end == ',' ? end + 1 : end;
+	}
+	return samples;
+}
+
+static double mean_of(const std::vector<double>& samples)
+{
+	double sum = 0;
+	for (double s : samples) {
+		sum += s;
+	}
+	return samples.empty() ? 0 : sum / samples.size();
+}
+
+static int tune(const flip_model_config& config, const flip_model_workload& workload, double seconds,
+	bool minmax_jitter, bool print_all)
+{
+	flip_model_tuning_options options = {};
+	options.sync_interval = config.sync_interval;
+	options.refresh_hz = config.refresh_hz;
+	options.present_call_ms = config.present_call_ms;
+	options.seconds = seconds;
+	options.max_frame_latency = 8;
+	options.max_buffer_count = 8;
+	options.max_gpu_frame_count = 8;
+	options.minmax_jitter = minmax_jitter;
+
+	printf("sync %d, %.0fHz, CPU %.2fms (%zu samples), GPU %.2fms (%zu samples), %.0fs per configuration\n",
+		config.sync_interval, config.refresh_hz, mean_of(workload.cpu_ms), workload.cpu_ms.size(),
+		mean_of(workload.gpu_ms), workload.gpu_ms.size(), seconds);
+
+	auto candidates = tune_flip_model(options, workload);
+	std::stable_sort(candidates.begin(), candidates.end(), [](const flip_model_candidate& a, const flip_model_candidate& b) {
+		return a.results.avg_latency_ms < b.results.avg_latency_ms;
+	});
+	size_t best = recommend_flip_model(candidates);
+
+	printf("  waitable latency buffers gpu_frames   latency  %s  dropped  shown fps\n", minmax_jitter ? "MinMaxDev" : "   StdDev");
+	for (size_t i = 0; i < candidates.size(); ++i)
+	{
+		auto& c = candidates[i];
+		if (!c.pareto && !print_all) {
+			continue;
+		}
+		printf("%c %8d %7d %7d %10d %7.2fms %7.2fms %7.2f%% %10.1f\n",
+			i == best ? '>' : c.pareto ? '*' : ' ',
+			c.config.use_waitable_object, c.config.max_frame_latency, c.config.swapchain_buffer_count,
+			c.config.gpu_frame_count, c.results.avg_latency_ms, c.jitter_ms,
+			100 * c.results.dropped_rate, c.results.displayed_fps);
+	}
+
+	if (best == candidates.size()) {
+		printf("no configuration works\n");
+		return 2;
+	}
+
+	auto opts = get_swapchain_options(candidates[best].config);
+	printf("\nrecommended dx12_swapchain_options:\n"
+		"\tswapchain_opts.create_time.use_waitable_object = %d;\n"
+		"\tswapchain_opts.create_time.max_frame_latency = %d;\n"
+		"\tswapchain_opts.create_time.swapchain_buffer_count = %d;\n"
+		"\tswapchain_opts.create_time.gpu_frame_count = %d;\n",
+		opts.create_time.use_waitable_object, opts.create_time.max_frame_latency,
+		opts.create_time.swapchain_buffer_count, opts.create_time.gpu_frame_count);
+	return 0;
+}
+
+// Appends the events committed since the last call, as eviz_cli reads them
+static void write_commits(FILE *file, EventViz::EventStream& eviz, UINT64& commit_count)
+{
+	std::vector<EventViz::EventData> records;
+	if (!eviz.GetCommitsSince(commit_count, records)) {
+		fprintf(stderr, "events were lost: write the trace more often\n");
+	}
+	commit_count = eviz.GetCommitCount();
+
+	for (auto& record : records)
+	{
+		if (record.Queue >= eviz.GetQueueCount()) {
+			continue; // a trim; eviz_cli trims on its own
+		}
+		auto type = (const eventviz_aux *)record.UserData;
+		fprintf(file, "%s,%llu,", eviz.GetQueueName(record.Queue), (unsigned long long)record.Start);
+		if (record.End == ~0ULL) {
+			fprintf(file, "dropped,");
+		} else {
+			fprintf(file, "%llu,", (unsigned long long)record.End);
+		}
+		fprintf(file, "%llu,%s\n", (unsigned long long)record.UserID, type ? type->name : "");
+	}
+}
+
+static void print_percentiles(const char *name, const LatencyHistogram& histogram)
+{
+	static const double percents[] = { 50, 90, 99, 99.9 };
+	double values[4];
+	histogram.GetPercentiles(percents, 4, values);
+	printf("%s: %llu latencies, p50 %.2fms, p90 %.2fms, p99 %.2fms, p99.9 %.2fms\n", name,
+		(unsigned long long)histogram.GetCount(), values[0], values[1], values[2], values[3]);
+}
+
+static void usage()
+{
+	printf(
+		"usage: flip_sim [options]\n"
+		"Simulates the sample's frame loop on a flip-discard swap chain.\n"
+		"  --waitable 0|1    use the frame latency waitable object (1)\n"
+		"  --latency N       maximum frame latency, with the waitable object (2)\n"
+		"  --buffers N       swap chain buffer count (3)\n"
+		"  --gpu-frames N    frames the CPU can be ahead of the GPU (3)\n"
+		"  --sync N          sync interval (1)\n"
+		"  --refresh HZ      display refresh rate (60)\n"
+		"  --cpu-ms LIST     CPU time per frame, one value or samples (5)\n"
+		"  --gpu-ms LIST     GPU time per frame, one value or samples (5)\n"
+		"  --present-ms MS   time in Present() when it does not block (0.1)\n"
+		"  --seconds S       simulated time (60)\n"
+		"  --seed N          for drawing frame times (1)\n"
+		"  --write-trace FILE  save the EventViz events for eviz_cli\n"
+		"  --histogram FILE  add the measured latencies to those in FILE\n"
+		"  --pacing-csv FILE  log the frame pacing of every present, PresentMon style\n"
+		"  --tune            search the swap chain options instead, keeping the\n"
+		"                    sync interval, refresh rate and frame times\n"
+		"  --jitter stddev|minmax  the jitter metric --tune ranks by (stddev)\n"
+		"  --all             with --tune, list every configuration, not only the\n"
+		"                    Pareto front (*); > marks the recommended one\n"
+		"A LIST is one value, comma separated samples, or @file.\n");
+}
+
+int main(int argc, char **argv)
+{
+	flip_model_config config = {};
+	config.use_waitable_object = 1;
+	config.max_frame_latency = 2;
+	config.swapchain_buffer_count = 3;
+	config.gpu_frame_count = 3;
+	config.sync_interval = 1;
+	config.refresh_hz = 60;
+	config.present_call_ms = 0.1;
+
+	flip_model_workload workload;
+	workload.cpu_ms = { 5 };
+	workload.gpu_ms = { 5 };
+	workload.seed = 1;
+
+	double seconds = 60;
+	const char *trace_path = nullptr;
+	const char *histogram_path = nullptr;
+	const char *pacing_path = nullptr;
+	bool tuning = false, minmax_jitter = false, print_all = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		if (!strcmp(arg, "--tune")) {
+			tuning = true;
+			continue;
+		}
+		if (!strcmp(arg, "--all")) {
+			print_all = true;
+			continue;
+		}
+
+		const char *value = i + 1 < argc ? argv[++i] : nullptr;
+		if (!value) {
+			usage();
+			return 1;
+		}
+
+		if (!strcmp(arg, "--waitable")) config.use_waitable_object = atoi(value);
+		else if (!strcmp(arg, "--latency")) config.max_frame_latency = atoi(value);
+		else if (!strcmp(arg, "--buffers")) config.swapchain_buffer_count = atoi(value);
+		else if (!strcmp(arg, "--gpu-frames")) config.gpu_frame_count = atoi(value);
+		else if (!strcmp(arg, "--sync")) config.sync_interval = atoi(value);
+		else if (!strcmp(arg, "--refresh")) config.refresh_hz = atof(value);
+		else if (!strcmp(arg, "--cpu-ms")) workload.cpu_ms = parse_samples(value);
+		else if (!strcmp(arg, "--gpu-ms")) workload.gpu_ms = parse_samples(value);
+		else if (!strcmp(arg, "--present-ms")) config.present_call_ms = atof(value);
+		else if (!strcmp(arg, "--seconds")) seconds = atof(value);
+		else if (!strcmp(arg, "--seed")) workload.seed = (unsigned)atoi(value);
+		else if (!strcmp(arg, "--write-trace")) trace_path = value;
+		else if (!strcmp(arg, "--histogram")) histogram_path = value;
+		else if (!strcmp(arg, "--pacing-csv")) pacing_path = value;
+		else if (!strcmp(arg, "--jitter")) minmax_jitter = !strcmp(value, "minmax");
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if (config.refresh_hz <= 0 || workload.cpu_ms.empty() || workload.gpu_ms.empty()) {
+		usage();
+		return 1;
+	}
+
+	if (tuning) {
+		return tune(config, workload, seconds, minmax_jitter, print_all);
+	}
+
+	EventViz::EventStream eviz;
+	FILE *trace = nullptr;
+	if (trace_path)
+	{
+		trace = fopen(trace_path, "w");
+		if (!trace) {
+			fprintf(stderr, "cannot create %s\n", trace_path);
+			return 1;
+		}
+		fprintf(trace, "# queue,start,end,user_id,type\n");
+		eviz.Pause(false);
+	}
+
+	flip_model_sim sim(config, workload, trace ? &eviz : nullptr);
+	if (pacing_path)
+	{
+		sim.pacing_csv = fopen(pacing_path, "w");
+		if (!sim.pacing_csv) {
+			fprintf(stderr, "cannot create %s\n", pacing_path);
+			return 1;
+		}
+		WritePresentMonCsvHeader(sim.pacing_csv);
+	}
+	UINT64 end_time = sim.now() + SecondsToQpcTime(seconds);
+	UINT64 commit_count = 0;
+
+	auto wall_start = std::chrono::steady_clock::now();
+	while (sim.now() < end_time)
+	{
+		sim.run_frame();
+		if (trace) {
+			write_commits(trace, eviz, commit_count);
+		}
+	}
+	std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wall_start;
+
+	if (trace) {
+		fclose(trace);
+	}
+	if (sim.pacing_csv) {
+		sim.flush_pacing();
+		fclose(sim.pacing_csv);
+	}
+
+	auto r = sim.get_results();
+	auto& c = sim.get_config();
+	printf("waitable %d, latency %d, buffers %d, gpu frames %d, sync %d, %.0fHz\n",
+		c.use_waitable_object, c.max_frame_latency, c.swapchain_buffer_count, c.gpu_frame_count,
+		c.sync_interval, c.refresh_hz);
+	printf("%.1fs: %llu presents (%.1f fps), %llu shown (%.1f fps), %llu dropped (%.2f%%)\n",
+		r.seconds, (unsigned long long)r.frames, r.fps, (unsigned long long)r.displayed, r.displayed_fps,
+		(unsigned long long)r.dropped, 100 * r.dropped_rate);
+	printf("latency %.2fms\n", r.avg_latency_ms);
+	printf("measured: latency %.2fms, StdDev %.2fms, MinMaxDev %.2fms, dropped %.2f%%\n",
+		r.measured_latency_ms, r.stddev_jitter_ms, r.minmax_jitter_ms, 100 * r.measured_dropped_rate);
+	printf("waits per frame: swap chain %.2fms, frame %.2fms, present %.2fms\n",
+		r.swapchain_wait_ms, r.frame_wait_ms, r.present_wait_ms);
+	print_percentiles("measured", sim.latency_histogram);
+	printf("pacing: %llu missed refreshes, queue depth %.2f average, %u max\n",
+		(unsigned long long)r.missed_refreshes, r.avg_queue_depth, r.max_queue_depth);
+	if (r.stalls) {
+		printf("%llu waits never ended\n", (unsigned long long)r.stalls);
+	}
+
+	if (histogram_path)
+	{
+		LatencyHistogram merged;
+		if (FILE *in = fopen(histogram_path, "r")) {
+			bool valid = merged.Read(in);
+			fclose(in);
+			if (!valid) {
+				fprintf(stderr, "%s is not a LatencyHistogram\n", histogram_path);
+				return 1;
+			}
+		}
+		merged.Merge(sim.latency_histogram);
+		FILE *out = fopen(histogram_path, "w");
+		if (!out) {
+			fprintf(stderr, "cannot create %s\n", histogram_path);
+			return 1;
+		}
+		merged.Write(out);
+		fclose(out);
+		print_percentiles(histogram_path, merged);
+	}
+	printf("simulated %.0f frames per second\n", r.frames / wall.count());
+	return r.stalls ? 2 : 0;
+}
@@ -0,0 +1,458 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+// timeline_bench: timeline_multimap against std::multimap, a B-tree and a
+// sorted deque, on the insertion patterns of the sample:
+//   cpu        CPU events, in order
+//   gpu        CPU events, and the GPU events of each frame one frame late
+//   present    CPU events, and presents in bursts as they are dequeued
+//   trim       CPU events with the history trimmed, and a window laid out,
+//              every frame
+// Each container replays the same operations. Throughput is over a whole
+// run; latency is of single operations, timed one at a time in another run,
+// less what reading the clock costs.
+//
+// Build from the repository root, on any platform:
+//   g++ -std=c++14 -O2 -ISource Tools/timeline_bench.cpp -o timeline_bench
+//   cl /EHsc /O2 /ISource Tools\timeline_bench.cpp
+//
+// ./timeline_bench runs every pattern, ./timeline_bench gpu ... only those
+// named; --frames N sets how many frames each one records (3000).
+
+#include "timeline_multimap.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef uint64_t key_type;
+typedef const void *mapped_type; // what EventViz keeps: a pointer to the record
+
+// Keeps the compiler from dropping work whose result is not used
+static volatile uint64_t sink;
+
+/// ----------------------------------------------------------------------
+///                              Containers
+/// ----------------------------------------------------------------------
+// Each one can insert, erase everything before a key, and visit the
+// entries in [from, to].
+
+struct timeline_container
+{
+	static const char *name() { return "timeline_multimap"; }
+
+	void insert(key_type k, mapped_type v) { map.emplace(k, v); }
+	void erase_before(key_type k) { map.erase(map.begin(), map.lower_bound(k)); }
+	uint64_t query(key_type from, key_type to)
+	{
+		uint64_t sum = 0;
+		for (auto it = map.lower_bound(from), last = map.upper_bound(to); it != last; ++it) {
+			sum += uintptr_t(it->second);
+		}
+		return sum;
+	}
+
+	timeline_multimap<key_type, mapped_type> map;
+};
+
+struct multimap_container
+{
+	static const char *name() { return "std::multimap"; }
+
+	// Hinted at the end, which is where most inserts go
+	void insert(key_type k, mapped_type v) { map.emplace_hint(map.end(), k, v); }
+	void erase_before(key_type k) { map.erase(map.begin(), map.lower_bound(k)); }
+	uint64_t query(key_type from, key_type to)
+	{
+		uint64_t sum = 0;
+		for (auto it = map.lower_bound(from), last = map.upper_bound(to); it != last; ++it) {
+			sum += uintptr_t(it->second);
+		}
+		return sum;
+	}
+
+	std::multimap<key_type, mapped_type> map;
+};
+
+// A B+tree of two levels: sorted leaves of up to 64 entries, indexed by
+// their first keys. Leaves are split in two when full, except the last one,
+// which starts a new leaf so that appending fills leaves completely. Two
+// levels are enough for the history EventViz keeps; the index is a deque so
+// that whole leaves come off the front in constant time.
+struct btree_container
+{
+	static const char *name() { return "B-tree"; }
+
+	enum : size_t { leaf_capacity = 64 };
+	typedef std::pair<key_type, mapped_type> entry;
+	typedef std::vector<entry> leaf;
+
+	static bool before(const entry& a, const entry& b) { return a.first < b.first; }
+
+	void insert(key_type k, mapped_type v)
+	{
+		entry e(k, v);
+		// The last leaf whose first key is <= k
+		size_t i = std::upper_bound(firsts.begin(), firsts.end(), k) - firsts.begin();
+		i = i ? i - 1 : 0;
+		if (leaves.empty()) {
+			leaves.emplace_back();
+			leaves.back().reserve(leaf_capacity);
+			firsts.push_back(k);
+		}
+		leaf *l = &leaves[i];
+		if (l->size() == leaf_capacity) {
+			if (i + 1 == leaves.size() && !(k < l->back().first)) {
+				// Appending: start a new leaf
+				leaves.emplace_back();
+				leaves.back().reserve(leaf_capacity);
+				firsts.push_back(k);
+				leaves.back().push_back(e);
+				return;
+			}
+			split(i);
+			if (!(k < firsts[i + 1])) {
+				++i;
+			}
+			l = &leaves[i];
+		}
+		l->insert(std::upper_bound(l->begin(), l->end(), e, before), e);
+		firsts[i] = l->front().first;
+	}
+
+	void erase_before(key_type k)
+	{
+		while (!leaves.empty() && leaves.front().back().first < k) {
+			leaves.pop_front();
+			firsts.pop_front();
+		}
+		if (!leaves.empty()) {
+			auto& l = leaves.front();
+			l.erase(l.begin(), std::lower_bound(l.begin(), l.end(), entry(k, nullptr), before));
+			firsts.front() = l.front().first;
+		}
+	}
+
+	uint64_t query(key_type from, key_type to)
+	{
+		uint64_t sum = 0;
+		size_t i = std::lower_bound(firsts.begin(), firsts.end(), from) - firsts.begin();
+		i = i ? i - 1 : 0; // the leaf before may still hold keys >= from
+		for (; i < leaves.size() && firsts[i] <= to; ++i) {
+			auto& l = leaves[i];
+			for (auto it = std::lower_bound(l.begin(), l.end(), entry(from, nullptr), before);
+				it != l.end() && it->first <= to; ++it)
+			{
+				sum += uintptr_t(it->second);
+			}
+		}
+		return sum;
+	}
+
+	void split(size_t i)
+	{
+		leaf upper(leaves[i].begin() + leaf_capacity / 2, leaves[i].end());
+		upper.reserve(leaf_capacity);
+		leaves[i].resize(leaf_capacity / 2);
+		firsts.insert(firsts.begin() + i + 1, upper.front().first);
+		leaves.insert(leaves.begin() + i + 1, std::move(upper));
+	}
+
+	std::deque<leaf> leaves;
+	std::deque<key_type> firsts; // the first key of each leaf
+};
+
+struct deque_container
+{
+	static const char *name() { return "sorted deque"; }
+
+	typedef std::pair<key_type, mapped_type> entry;
+	static bool before(const entry& a, const entry& b) { return a.first < b.first; }
+
+	void insert(key_type k, mapped_type v)
+	{
+		entry e(k, v);
+		if (entries.empty() || !(k < entries.back().first)) {
+			entries.push_back(e);
+		} else {
+			entries.insert(std::upper_bound(entries.begin(), entries.end(), e, before), e);
+		}
+	}
+	void erase_before(key_type k)
+	{
+		entries.erase(entries.begin(), std::lower_bound(entries.begin(), entries.end(), entry(k, nullptr), before));
+	}
+	uint64_t query(key_type from, key_type to)
+	{
+		uint64_t sum = 0;
+		for (auto it = std::lower_bound(entries.begin(), entries.end(), entry(from, nullptr), before);
+			it != entries.end() && it->first <= to; ++it)
+		{
+			sum += uintptr_t(it->second);
+		}
+		return sum;
+	}
+
+	std::deque<entry> entries;
+};
+
+/// ----------------------------------------------------------------------
+///                               Patterns
+/// ----------------------------------------------------------------------
+
+enum op_type { op_insert, op_trim, op_query, op_type_count };
+static const char *op_names[op_type_count] = { "insert", "trim", "query" };
+
+struct op
+{
+	op_type type;
+	key_type key; // to insert, or to trim to, or the start of the window
+	key_type end; // of the window
+};
+
+struct pattern
+{
+	const char *name;
+	const char *description;
+	void (*generate)(int frames, std::vector<op>& ops);
+};
+
+// 100us ticks at 60 frames per second, like the QPC times the app records
+static const key_type frame_ticks = 166667;
+static const int cpu_events_per_frame = 100;
+
+static void add_cpu_frame(int frame, std::mt19937& rng, std::vector<op>& ops)
+{
+	key_type t = key_type(frame + 1) * frame_ticks;
+	for (int i = 0; i < cpu_events_per_frame; ++i) {
+		t += rng() % (frame_ticks / cpu_events_per_frame);
+		ops.push_back({ op_insert, t, 0 });
+	}
+}
+
+static void generate_cpu(int frames, std::vector<op>& ops)
+{
+	std::mt19937 rng(1);
+	for (int f = 0; f < frames; ++f) {
+		add_cpu_frame(f, rng, ops);
+	}
+}
+
+// The GPU work of a frame is only known once its queries are read back,
+// after the CPU has recorded the next frame (see eviz_gpu_event).
+static void generate_gpu(int frames, std::vector<op>& ops)
+{
+	std::mt19937 rng(2);
+	for (int f = 0; f < frames; ++f) {
+		add_cpu_frame(f, rng, ops);
+		if (f) {
+			key_type t = key_type(f) * frame_ticks;
+			for (int i = 0; i < 10; ++i) {
+				t += rng() % (frame_ticks / 10);
+				ops.push_back({ op_insert, t, 0 });
+			}
+		}
+	}
+}
+
+// A present is recorded when it leaves the queue, one to four frames after
+// it started, and several leave together when the app catches up.
+static void generate_present(int frames, std::vector<op>& ops)
+{
+	std::mt19937 rng(3);
+	std::deque<key_type> queued;
+	for (int f = 0; f < frames; ++f) {
+		add_cpu_frame(f, rng, ops);
+		queued.push_back(key_type(f + 1) * frame_ticks + frame_ticks - 1000);
+		if (queued.size() >= 4 || rng() % 3 == 0) {
+			for (key_type start : queued) {
+				ops.push_back({ op_insert, start, 0 });
+			}
+			queued.clear();
+		}
+	}
+}
+
+// What EventStream::TrimToLastNVsyncs and CreateVisualization do every
+// frame: keep 256 frames of history and look at the last 16.
+static void generate_trim(int frames, std::vector<op>& ops)
+{
+	std::mt19937 rng(4);
+	for (int f = 0; f < frames; ++f) {
+		add_cpu_frame(f, rng, ops);
+		key_type now = key_type(f + 2) * frame_ticks;
+		if (f >= 256) {
+			ops.push_back({ op_trim, now - 256 * frame_ticks, 0 });
+		}
+		ops.push_back({ op_query, now - std::min(f + 1, 16) * frame_ticks, now });
+	}
+}
+
+static const pattern patterns[] = {
+	{ "cpu", "CPU events, in order", generate_cpu },
+	{ "gpu", "CPU events, with the GPU events of the previous frame", generate_gpu },
+	{ "present", "CPU events, with presents inserted in bursts as they are dequeued", generate_present },
+	{ "trim", "CPU events, trimmed to 256 frames with a 16-frame window queried every frame", generate_trim },
+};
+
+/// ----------------------------------------------------------------------
+///                               Running
+/// ----------------------------------------------------------------------
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double elapsed_ns(bench_clock::time_point start, bench_clock::time_point end)
+{
+	return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+template<class Container>
+static void apply(Container& c, const op& o, uint64_t& sum)
+{
+	switch (o.type) {
+	case op_insert: c.insert(o.key, &o); break;
+	case op_trim: c.erase_before(o.key); break;
+	case op_query: sum += c.query(o.key, o.end); break;
+	default: break;
+	}
+}
+
+// What timing an operation costs, when there is none
+static double clock_overhead_ns()
+{
+	std::vector<double> samples;
+	for (int i = 0; i < 10001; ++i) {
+		auto start = bench_clock::now();
+		auto end = bench_clock::now();
+		samples.push_back(elapsed_ns(start, end));
+	}
+	std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+	return samples[samples.size() / 2];
+}
+
+static double percentile(std::vector<double>& samples, double p)
+{
+	if (samples.empty()) {
+		return 0;
+	}
+	size_t i = std::min(samples.size() - 1, size_t(p * samples.size()));
+	std::nth_element(samples.begin(), samples.begin() + i, samples.end());
+	return samples[i];
+}
+
+template<class Container>
+static void run(const std::vector<op>& ops, double overhead)
+{
+	// Throughput, over the whole run; the best of three
+	double best = 0;
+	for (int repeat = 0; repeat < 3; ++repeat) {
+		Container c;
+		uint64_t sum = 0;
+		auto start = bench_clock::now();
+		for (auto& o : ops) {
+			apply(c, o, sum);
+		}
+		double ns = elapsed_ns(start, bench_clock::now());
+		sink = sum;
+		best = repeat ? std::min(best, ns) : ns;
+	}
+
+	// Latency of each operation
+	std::vector<double> samples[op_type_count];
+	{
+		Container c;
+		uint64_t sum = 0;
+		for (auto& o : ops) {
+			auto start = bench_clock::now();
+			apply(c, o, sum);
+			auto end = bench_clock::now();
+			samples[o.type].push_back(std::max(0.0, elapsed_ns(start, end) - overhead));
+		}
+		sink = sum;
+	}
+
+	printf("  %-18s %9.2f %8.1f", Container::name(), ops.size() * 1e3 / best, best / ops.size());
+	for (auto& s : samples) {
+		if (s.empty()) {
+			printf(" %20s", "-");
+		} else {
+			printf(" %6.0f %6.0f %6.0f", percentile(s, 0.5), percentile(s, 0.99), percentile(s, 1.0));
+		}
+	}
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+	int frames = 3000;
+	std::vector<const pattern*> selected;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+			frames = std::max(1, atoi(argv[++i]));
+			continue;
+		}
+		const pattern *found = nullptr;
+		for (auto& p : patterns) {
+			if (!strcmp(argv[i], p.name)) {
+				found = &p;
+			}
+		}
+		if (!found) {
+			printf("usage: timeline_bench [--frames N] [pattern...]\npatterns:");
+			for (auto& p : patterns) {
+				printf(" %s", p.name);
+			}
+			printf("\n");
+			return 1;
+		}
+		selected.push_back(found);
+	}
+	if (selected.empty()) {
+		for (auto& p : patterns) {
+			selected.push_back(&p);
+		}
+	}
+
+	double overhead = clock_overhead_ns();
+	printf("%d frames; latencies in ns, less %.0f ns of clock overhead\n\n", frames, overhead);
+
+	for (auto p : selected)
+	{
+		std::vector<op> ops;
+		p->generate(frames, ops);
+		printf("%s: %s, %zu operations\n", p->name, p->description, ops.size());
+		printf("  %-18s %9s %8s", "", "Mops/s", "ns/op");
+		for (auto name : op_names) {
+			printf(" %20s", (std::string(name) + " p50/p99/max").c_str());
+		}
+		printf("\n");
+		run<timeline_container>(ops, overhead);
+		run<multimap_container>(ops, overhead);
+		run<btree_container>(ops, overhead);
+		run<deque_container>(ops, overhead);
+		printf("\n");
+	}
+	return 0;
+}
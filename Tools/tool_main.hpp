@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WindowsHelpers.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+// What WindowsHelpers.cpp defines for the app, defined for the headless
+// tools: include it in the one file of a tool that has main. Defining
+// TOOL_COUNT_ALLOCATIONS first also replaces operator new, to count every
+// heap allocation of the process with get_allocation_count().
+
+// Traces are in 100ns ticks unless the tool says otherwise
+UINT64 g_QpcFreq = 10000000;
+
+UINT64 SecondsToQpcTime(double Seconds)
+{
+	return (UINT64)(g_QpcFreq*Seconds);
+}
+
+double QpcTimeToSeconds(UINT64 QpcTime)
+{
+	return (double)QpcTime / g_QpcFreq;
+}
+
+// steady_clock in QPC ticks, whole seconds and the rest apart so that
+// nanoseconds times the frequency cannot overflow
+UINT64 QpcNow()
+{
+	using namespace std::chrono;
+	UINT64 ns = (UINT64)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+	return ns / 1000000000 * g_QpcFreq + ns % 1000000000 * g_QpcFreq / 1000000000;
+}
+
+#ifdef TOOL_COUNT_ALLOCATIONS
+
+static std::atomic<size_t> allocation_count(0);
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+// Once these are inlined, GCC takes the free() of what operator new returned for a mismatch.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(size_t size)
+{
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if (void *p = malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	operator delete(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+	operator delete[](p);
+}
+
+static size_t get_allocation_count()
+{
+	return allocation_count.load(std::memory_order_relaxed);
+}
+
+#endif